@@ -3,7 +3,14 @@
  *
  */
 
+/* pthread_attr_setaffinity_np */
+#define _GNU_SOURCE
+#include <sched.h>
+
 #include "ai.h"
+#include "stats.h"
+#include "bitboard.h"
+#include "nnue.h"
 
 /* use pai_time */
 #include "pai.h"
@@ -11,33 +18,138 @@
 /* debug flag */
 #define AI_DEBUG GOMOKU_DEBUG
 
+/* AVX2 kernels, selected at runtime if the CPU supports them */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AI_AVX2 1
+#include <immintrin.h>
+#else
+#define AI_AVX2 0
+#endif
+
 /*
  * Scoring
  *
- * The board is divided to 572 groups with five points each in a line.
- * Pieces in each group is counted to give corresponding scores.
+ * The board is divided to groups with five points each in a line
+ * (572 groups on a 15x15 board).
+ * Each group is encoded as a pattern of its points and of the two
+ * bounding points next to its ends, which is updated incrementally,
+ * and the scores of all patterns are looked up from pattern_table
+ * built at startup. Bounding points tell open groups from groups closed
+ * by the opponent, the border, or (for black) a piece making overline.
+ * Groups are enumerated once by group_prepare, and each point keeps
+ * the list of groups containing or bounding it, so an update touches
+ * only those.
+ *
+ * Threats are maintained along with the scores, by the class of each
+ * group for each side in threat_table: a five, a four (4 pieces and a
+ * free point completing five) or a three (3 pieces and 2 free points,
+ * one move from a four). Groups with opponent's pieces, and for black
+ * groups bounded by black pieces (which would make overline), have no
+ * class. Fives are counted, and free points of fours and threes are
+ * recorded with the groups using them:
+ * - a broken four has one point completing five, and an open four (or
+ *   two fours) has two, so nwin > 1 cannot be blocked
+ * - a point free in two threes may make two fours at once, like a live
+ *   three becoming an open four, and then wins unless the opponent has
+ *   a three to answer with a four of its own (or black is banned there)
  *
  */
 
-/* scores and piece counts of a group */
+/* number of patterns of the 5 points of a group (3^5) */
+#define PATTERN_INNER 243
+
+/* number of patterns of a group, with 4 states of each bounding point */
+#define PATTERN_NUM (PATTERN_INNER*16)
+
+/* bounding points of a group */
+#define BOUND_LOW 5 /* before point 0 */
+#define BOUND_HIGH 6 /* after point 4 */
+
+/* state of a bounding point off the board */
+#define BOUND_BORDER 3
+
+/* weight of each point in a pattern, then of low & high bounding points */
+static const int pattern_weight[7] = {1, 3, 9, 27, 81, 243, 972};
+
+/* pattern of a group is the sum of piece (I_FREE, I_BLACK or I_WHITE) */
+/* times weight of each point, and BOUND_BORDER times weight of */
+/* each bounding point off the board */
+
+/* scores of a pattern */
 typedef struct {
   /* black & white */
   int score[2]; /* part of board score */
   int scorep[2]; /* part of point score */
-  int npiece[2];
-} group_score;
+} pattern_score;
+
+/* scores of all patterns, built by pattern_prepare */
+/* aligned to be loaded as vectors */
+static pattern_score pattern_table[PATTERN_NUM] __attribute__((aligned(16)));
+
+/* threat classes of a group */
+#define THREAT_NONE 0
+#define THREAT_THREE 1 /* 3 pieces and 2 free points */
+#define THREAT_FOUR 2 /* 4 pieces and a free point */
+#define THREAT_FIVE 3 /* 5 pieces */
+
+/* threats of a pattern */
+typedef struct {
+  unsigned char type[2]; /* class of black & white */
+  unsigned char slot[2]; /* indices of free points, one of a four */
+} pattern_threat;
+
+/* threats of all patterns, built by pattern_prepare */
+static pattern_threat threat_table[PATTERN_NUM];
+
+/* max number of groups on board */
+#define GROUP_MAX ((BOARD_MAX-4)*BOARD_MAX*2+(BOARD_MAX-4)*(BOARD_MAX-4)*2)
+
+/* max number of groups containing or bounding a point (7 in each line) */
+/* rounded up to a multiple of 8 for vector loads */
+#define POINT_GROUPS 32
+
+/* groups containing or bounding a point */
+/* groups are in the order of lines, and then along the line */
+/* (groups of a line are consecutive windows) */
+typedef struct {
+  int n; /* number of groups */
+  unsigned char nline[4]; /* number of groups in each line */
+  unsigned short group[POINT_GROUPS]; /* group indices */
+  unsigned short weight[POINT_GROUPS]; /* weight of the point in each group */
+} point_group;
+
+/* number of groups on board, built by group_prepare */
+static int group_num;
+/* index of the first group in each row of a line, built by group_prepare */
+static int group_row[4][BOARD_MAX];
+/* points of each group as indices of x*BOARD_MAX+y, built by group_prepare */
+static unsigned short group_point[GROUP_MAX][5];
+/* bounding points of each group as indices, or -1 off the board */
+static short group_bound[GROUP_MAX][2];
+/* pattern of bounding points off the board, built by group_prepare */
+static unsigned short group_border[GROUP_MAX];
+/* groups containing each point, built by group_prepare */
+static point_group point_groups[BOARD_MAX*BOARD_MAX];
 
 /* group status and scores of the board */
 typedef struct {
-  /* scores of groups in 4 directions */
-  group_score vertical[BOARD_W-4][BOARD_H];
-  group_score horizontal[BOARD_W][BOARD_H-4];
-  group_score backslash[BOARD_W-4][BOARD_H-4];
-  group_score slash[BOARD_W-4][BOARD_H-4];
+  /* pattern of each group */
+  unsigned short pattern[GROUP_MAX];
   /* point scores */
-  int scores[2][BOARD_W][BOARD_H]; /* black & white */
+  int scores[2][BOARD_MAX][BOARD_MAX]; /* black & white */
   /* board scores */
   int totalscore[2]; /* black & white */
+  /* threats, black & white */
+  int nfive[2]; /* number of fives */
+  int nwin[2]; /* number of points completing five */
+  uint32_t winmask[2][BOARD_MAX]; /* points completing five (bit = y) */
+  unsigned char wincount[2][BOARD_MAX*BOARD_MAX]; /* groups completed by each point */
+  int nthree[2]; /* number of threes */
+  int nlive[2]; /* number of points free in two threes */
+  uint32_t livemask[2][BOARD_MAX]; /* points free in two threes (bit = y) */
+  unsigned char threecount[2][BOARD_MAX*BOARD_MAX]; /* threes with each point free */
+  /* network accumulators, used if nnue_enabled */
+  nnue_acc acc;
 } board_score;
 
 /* line directions */
@@ -50,12 +162,12 @@ static const int linearr[][2] = {
 };
 
 /* group dimensions */
-/* width height xoffset yoffset */
+/* board size minus width, board size minus height, xoffset, yoffset */
 static const int groupdim[][4] = {
-  BOARD_W-4,  BOARD_H,    0,  0,
-  BOARD_W,    BOARD_H-4,  0,  0,
-  BOARD_W-4,  BOARD_H-4,  0,  0,
-  BOARD_W-4,  BOARD_H-4,  0,  4
+  4,  0,  0,  0,
+  0,  4,  0,  0,
+  4,  4,  0,  0,
+  4,  4,  0,  4
 };
 
 /* parameters for game tree searching with alpha beta cutting */
@@ -68,39 +180,122 @@ static const int groupdim[][4] = {
 /* length of maxpos buffer */
 #define MAXPOS_LEN 64
 
-/* number of parallel threads */
+/* default number of parallel threads */
 #define PARALLEL_THREADS 4
 
+/* number of top points whose order is varied by Lazy SMP threads */
+#define LAZY_ORDER 8
+
 /* max execution time for searching (in milliseconds) */
 #define MAX_TIME 14500
 
-/* parameters for threads in negamax_parallel */
+/* parameters for threads in negamax_parallel and negamax_lazy */
+/* aligned to cache lines, so that threads do not share lines */
 typedef struct {
   /* inter-thread shared variables */
   /* when *signaled is nonzero, stop searching */
   int *signaled; /* *signal indicates timeout, read only */
   pos *result; /* *result stores point with max score, synced */
   int *alpha; /* *alpha stores alpha value of root node, synced */
+  int *done; /* *done stores depth of *result (negamax_lazy), synced */
   pthread_mutex_t *mutex; /* mutex for sync, read only */
   /* private variables */
-  int move; /* current move count */
+  int id; /* thread number */
+  unsigned long long inittime; /* initial time */
   int depth; /* search depth */
   int width; /* search width */
   int role; /* current role id */
   int npos; /* length of maxpos */
   pos maxpos[MAXPOS_LEN]; /* points to be searched */
   int *scores[MAXPOS_LEN]; /* used to return position scores */
-  HASHVALUE hash; /* current hash value */
-  board_t board; /* current board */
+  hash_state hash; /* current hash state */
+  padboard_t board; /* current board */
+  bitboard bb; /* current bitboard */
+  banmap bm; /* current ban map */
   board_score bs; /* current board scores */
-} negamax_param;
+} __attribute__((aligned(64))) negamax_param;
+
+/*
+ * Thread pool
+ *
+ * Worker threads are created by ai_register_player and kept until
+ * ACTION_CLEANUP. Jobs are posted in batches: the caller fills the job
+ * array and publishes a claim word holding a new generation, the number
+ * of jobs and the next job index, and workers take jobs by increasing
+ * the index with compare-and-swap, which fails for stale generations.
+ * Idle workers spin for a while before sleeping, so that they are awake
+ * for the next iteration of deepening. The caller sleeps until the
+ * batch is finished, and sets the timeout flag if the deadline comes
+ * first.
+ *
+ */
+
+/* spins of an idle worker before sleeping */
+#define POOL_SPIN 65536
+
+/* pause in spin loops */
+#if defined(__x86_64__) || defined(__i386__)
+#define POOL_PAUSE() __builtin_ia32_pause()
+#else
+#define POOL_PAUSE()
+#endif
+
+/* claim word of the pool */
+#define POOL_CLAIM(gen, n) ((uint64_t)(gen) << 32 | (uint64_t)(n) << 16)
+#define POOL_GEN(c) ((unsigned)((c) >> 32))
+#define POOL_NJOBS(c) ((int)((c) >> 16 & 0xffff))
+#define POOL_NEXT(c) ((int)((c) & 0xffff))
 
-/* parameters for signal thread */
+/* a job of the pool */
 typedef struct {
-  unsigned long long inittime; /* initial time, read only */
-  int *signaled; /* timeout flag, set by signal thread */
-  int *exit; /* exit flag, set by main thread */
-} signal_param;
+  void *(*routine)(void *);
+  void *parameter;
+} pool_job;
+
+/* thread pool */
+typedef struct {
+  int nthreads; /* number of threads, 0 if not created */
+  pthread_t tid[AI_THREADS_MAX];
+  pthread_mutex_t mutex; /* for sleeping and waking */
+  pthread_cond_t work; /* a batch is posted, or exit is set */
+  pthread_cond_t done; /* a batch is finished */
+  /* current batch, written before claim is published */
+  pool_job jobs[AI_THREADS_MAX];
+  uint64_t claim; /* POOL_CLAIM of the batch plus index of next job (atomic) */
+  int pending; /* jobs not finished (atomic) */
+  int exit; /* stop workers (atomic) */
+} thread_pool;
+
+/* the pool shared by AI players */
+static thread_pool pool = {
+  .mutex = PTHREAD_MUTEX_INITIALIZER,
+  .work = PTHREAD_COND_INITIALIZER,
+  .done = PTHREAD_COND_INITIALIZER
+};
+
+/* number of threads and pinning of the pool, set by ai_threads */
+static int pool_size = PARALLEL_THREADS;
+static int pool_pin;
+
+/* search state of each thread */
+static negamax_param *pool_param;
+
+/* current evaluation weights */
+static ai_weights eval_weights = {
+  SCORE_S1, SCORE_S2, SCORE_S3, SCORE_S4, SCORE_S5,
+  SCORE_O1, SCORE_O2, SCORE_O3, SCORE_O4, SCORE_O5,
+  SCORE_VO, SCORE_PO
+};
+
+/* names of evaluation weights in weight files */
+static const char *weight_names[AI_WEIGHT_NUM] = {
+  "S1", "S2", "S3", "S4", "S5",
+  "O1", "O2", "O3", "O4", "O5",
+  "VO", "PO"
+};
+
+/* weight file loaded by ai_init */
+static const char *weight_file;
 
 /* score by the count of pieces */
 /* ns: num of pieces of my side */
@@ -109,95 +304,218 @@ typedef struct {
 static inline int score_by_count(int ns, int no, int neg) {
   /* pieces of both sides exist */
   if (ns && no)
-    return SCORE_PO;
+    return eval_weights[AI_WEIGHT_PO];
   /* only pieces of my side */
   else if (ns)
-    switch (ns) {
-      case 1: return SCORE_S1;
-      case 2: return SCORE_S2;
-      case 3: return SCORE_S3;
-      case 4: return SCORE_S4;
-      case 5: return SCORE_S5;
-    }
-  /* only opponent's pieces */
+    return eval_weights[AI_WEIGHT_S1+ns-1];
+  /* only opponent's pieces, negative score if neg */
   else if (no)
-    /* give negative score */
-    if (neg)
-      switch (no) {
-        case 1: return -SCORE_O1;
-        case 2: return -SCORE_O2;
-        case 3: return -SCORE_O3;
-        case 4: return -SCORE_O4;
-        case 5: return -SCORE_O5;
-      }
-    /* otherwise */
-    else
-      switch (no) {
-        case 1: return SCORE_O1;
-        case 2: return SCORE_O2;
-        case 3: return SCORE_O3;
-        case 4: return SCORE_O4;
-        case 5: return SCORE_O5;
-      }
+    return neg ? -eval_weights[AI_WEIGHT_O1+no-1] : eval_weights[AI_WEIGHT_O1+no-1];
   /* no pieces */
   else
-    return SCORE_VO;
-  return 0;
+    return eval_weights[AI_WEIGHT_VO];
 }
 
-/* score all groups on board using board_score struct */
-/* board: current board */
-/* bscore: struct to store scores */
-static void score_board_by_struct(board_t board, board_score *bscore) {
-  group_score *gs; /* pointer to a group_score field in board_score */
-  int sb = 0, sw = 0; /* score of black & white */
+/* nonzero if a bounding point closes the group for piece */
+/* black is also closed by its own piece, which would make overline */
+static inline int bound_closed(int bound, int piece) {
+  return bound == BOUND_BORDER || (bound != I_FREE && (bound != piece || piece == I_BLACK));
+}
+
+/* count of pieces of one side in a group, by the shape of the group */
+/* ns: num of pieces of the side */
+/* no: num of opponent's pieces */
+/* lo, hi: bounding points */
+/* piece: piece of the side */
+static int shape_count(int ns, int no, int lo, int hi, int piece) {
+  int closed;
+  /* no shape unless only pieces of the side exist */
+  if (!ns || no)
+    return ns;
+  /* black cannot make five without overline */
+  if (ns >= 4)
+    return piece == I_BLACK && (lo == I_BLACK || hi == I_BLACK) ? 0 : ns;
+  /* each closed end counts as one piece less */
+  closed = bound_closed(lo, piece)+bound_closed(hi, piece);
+  return ns > closed ? ns-closed : 0;
+}
+
+/* threat class of one side in a group */
+/* ns: num of pieces of the side */
+/* no: num of opponent's pieces */
+/* lo, hi: bounding points */
+/* piece: piece of the side */
+static int threat_class(int ns, int no, int lo, int hi, int piece) {
+  /* black cannot make five without overline */
+  if (no || ns < 3 || (piece == I_BLACK && (lo == I_BLACK || hi == I_BLACK)))
+    return THREAT_NONE;
+  return ns == 5 ? THREAT_FIVE : ns == 4 ? THREAT_FOUR : THREAT_THREE;
+}
+
+/* build pattern_table and threat_table from piece counts and shapes */
+/* of each pattern */
+static void pattern_prepare() {
+  int i, k, p, nb, nw, lo, hi, eb, ew, nfree, slot[2];
+  for (i=0; i<PATTERN_NUM; i++) {
+    /* count pieces */
+    nb = nw = nfree = 0;
+    slot[0] = slot[1] = 0;
+    for (k=0, p=i%PATTERN_INNER; k<5; k++, p/=3)
+      if (p%3 == I_BLACK)
+        nb++;
+      else if (p%3 == I_WHITE)
+        nw++;
+      else if (nfree < 2)
+        slot[nfree++] = k;
+    /* bounding points */
+    lo = i/PATTERN_INNER%4;
+    hi = i/PATTERN_INNER/4;
+    eb = shape_count(nb, nw, lo, hi, I_BLACK);
+    ew = shape_count(nw, nb, lo, hi, I_WHITE);
+    pattern_table[i].score[0] = score_by_count(eb, ew, 1);
+    pattern_table[i].score[1] = score_by_count(ew, eb, 1);
+    pattern_table[i].scorep[0] = score_by_count(eb, ew, 0);
+    pattern_table[i].scorep[1] = score_by_count(ew, eb, 0);
+    threat_table[i].type[0] = threat_class(nb, nw, lo, hi, I_BLACK);
+    threat_table[i].type[1] = threat_class(nw, nb, lo, hi, I_WHITE);
+    threat_table[i].slot[0] = slot[0];
+    threat_table[i].slot[1] = slot[1];
+  }
+}
+
+/* enumerate groups of the current board size */
+/* the board size should be set before calling */
+static void group_prepare() {
   int line; /* line 0~3  */
-  int i, x0, y0, x, y, nb, nw; /* iteration variables */
-  /* clear fields */
-  memset(bscore, 0, sizeof(board_score));
+  int i, x0, y0, x, y, index, weight; /* iteration variables */
+  point_group *pg;
+  group_num = 0;
+  memset(point_groups, 0, sizeof(point_groups));
   /* iterate each line */
   for (line=0; line<4; line++)
     /* iterate each group horizontally */
-    for (x0=0; x0<groupdim[line][0]; x0++)
+    for (x0=0; x0<BOARD_W-groupdim[line][0]; x0++) {
+      group_row[line][x0] = group_num;
       /* iterate each group vertically */
-      for (y0=0; y0<groupdim[line][1]; y0++) {
-        nb = nw = 0;
-        /* iterate each point in the group */
+      for (y0=0; y0<BOARD_H-groupdim[line][1]; y0++) {
+        group_border[group_num] = 0;
+        /* iterate each point in the group, and bounding points before */
+        /* and after them */
         for (
-            i=0, x=x0+groupdim[line][2], y=y0+groupdim[line][3];
-            i<5; i++, x+=linearr[line][0], y+=linearr[line][1]
-            )
-          /* count pieces */
-          if (board[x][y] == I_BLACK)
-            nb++;
-          else if (board[x][y] == I_WHITE)
-            nw++;
-        /* judge direction */
-        switch (line) {
-          case 0: gs = &bscore->vertical[x0][y0]; break;
-          case 1: gs = &bscore->horizontal[x0][y0]; break;
-          case 2: gs = &bscore->backslash[x0][y0]; break;
-          case 3: gs = &bscore->slash[x0][y0]; break;
-        }
-        /* record piece counts */
-        gs->npiece[0] = nb;
-        gs->npiece[1] = nw;
-        /* record scores of board and group scores */
-        bscore->totalscore[0] += (gs->score[0] = score_by_count(nb, nw, 1));
-        bscore->totalscore[1] += (gs->score[1] = score_by_count(nw, nb, 1));
-        /* calculate point scores */
-        sb = gs->scorep[0] = score_by_count(nb, nw, 0);
-        sw = gs->scorep[1] = score_by_count(nw, nb, 0);
-        /* update point scores */
-        for (
-            i=0, x=x0+groupdim[line][2], y=y0+groupdim[line][3];
-            i<5; i++, x+=linearr[line][0], y+=linearr[line][1]
+            i=-1, x=x0+groupdim[line][2]-linearr[line][0], y=y0+groupdim[line][3]-linearr[line][1];
+            i<6; i++, x+=linearr[line][0], y+=linearr[line][1]
             )
         {
-          bscore->scores[0][x][y] += sb;
-          bscore->scores[1][x][y] += sw;
+          weight = pattern_weight[i<0 ? BOUND_LOW : i<5 ? i : BOUND_HIGH];
+          /* bounding point off the board */
+          if (!VALID_COORD(x, y)) {
+            group_bound[group_num][i>0] = -1;
+            group_border[group_num] += BOUND_BORDER*weight;
+            continue;
+          }
+          index = x*BOARD_MAX+y;
+          if (i<0 || i>=5)
+            group_bound[group_num][i>0] = index;
+          else
+            group_point[group_num][i] = index;
+          /* add group to the point */
+          pg = &point_groups[index];
+          pg->group[pg->n] = group_num;
+          pg->weight[pg->n] = weight;
+          pg->nline[line]++;
+          pg->n++;
         }
+        group_num++;
       }
+    }
+}
+
+/* add (delta = 1) or remove (delta = -1) threats of group g with pattern */
+static inline void threat_group(board_score *bscore, int g, int pattern, int delta) {
+  pattern_threat *pt = &threat_table[pattern];
+  int role, k, index;
+  for (role=0; role<2; role++)
+    switch (pt->type[role]) {
+      case THREAT_FIVE:
+        bscore->nfive[role] += delta;
+        break;
+      case THREAT_FOUR:
+        /* record the point completing five */
+        index = group_point[g][pt->slot[0]];
+        if (delta>0 ? bscore->wincount[role][index]++ == 0 : --bscore->wincount[role][index] == 0) {
+          bscore->winmask[role][index/BOARD_MAX] ^= 1u << index%BOARD_MAX;
+          bscore->nwin[role] += delta;
+        }
+        break;
+      case THREAT_THREE:
+        bscore->nthree[role] += delta;
+        /* record points free in two threes */
+        for (k=0; k<2; k++) {
+          index = group_point[g][pt->slot[k]];
+          if (delta>0 ? ++bscore->threecount[role][index] == 2 : bscore->threecount[role][index]-- == 2) {
+            bscore->livemask[role][index/BOARD_MAX] ^= 1u << index%BOARD_MAX;
+            bscore->nlive[role] += delta;
+          }
+        }
+        break;
+    }
+}
+
+/* update threats of group g from pattern po to pattern pn */
+static inline void threat_delta(board_score *bscore, int g, int po, int pn) {
+  /* most moves do not change classes, and free points change only */
+  /* with them */
+  if (threat_table[po].type[0] == threat_table[pn].type[0] &&
+      threat_table[po].type[1] == threat_table[pn].type[1])
+    return;
+  threat_group(bscore, g, po, -1);
+  threat_group(bscore, g, pn, 1);
+}
+
+/* record threats of all groups */
+static void threat_board(board_score *bscore) {
+  int g;
+  for (g=0; g<group_num; g++)
+    threat_group(bscore, g, bscore->pattern[g], 1);
+}
+
+/* encode pieces of group g and its bounding points */
+/* points: board as array of x*BOARD_MAX+y */
+static inline int group_pattern(const char *points, int g) {
+  int i, pattern = group_border[g];
+  for (i=0; i<5; i++)
+    pattern += points[group_point[g][i]]*pattern_weight[i];
+  for (i=0; i<2; i++)
+    if (group_bound[g][i] >= 0)
+      pattern += points[group_bound[g][i]]*pattern_weight[BOUND_LOW+i];
+  return pattern;
+}
+
+/* score all groups on board using board_score struct */
+/* board: current board */
+/* bscore: struct to store scores */
+static void score_board_scalar(board_t board, board_score *bscore) {
+  pattern_score *ps; /* scores of the pattern */
+  char *points = board[0]; /* board as array of x*BOARD_MAX+y */
+  int *sb = bscore->scores[0][0], *sw = bscore->scores[1][0]; /* point scores */
+  int g, i, pattern; /* iteration variables */
+  /* clear fields */
+  memset(bscore, 0, sizeof(board_score));
+  /* iterate each group */
+  for (g=0; g<group_num; g++) {
+    pattern = group_pattern(points, g);
+    /* record pattern */
+    bscore->pattern[g] = pattern;
+    ps = &pattern_table[pattern];
+    /* record scores of board */
+    bscore->totalscore[0] += ps->score[0];
+    bscore->totalscore[1] += ps->score[1];
+    /* update point scores */
+    for (i=0; i<5; i++) {
+      sb[group_point[g][i]] += ps->scorep[0];
+      sw[group_point[g][i]] += ps->scorep[1];
+    }
+  }
 }
 
 /* update board_score struct by difference */
@@ -205,150 +523,535 @@ static void score_board_by_struct(board_t board, board_score *bscore) {
 /* newpos: new piece */
 /* role: role of new piece */
 /* remove: place (0) or remove (nonzero) */
-static void score_struct_delta(board_score *bscore, pos *newpos, int role, int remove) {
-  group_score *gs; /* pointer to a group_score field in board_score */
+static void score_delta_scalar(board_score *bscore, pos *newpos, int role, int remove) {
+  point_group *pg = &point_groups[newpos->x*BOARD_MAX+newpos->y]; /* groups containing or bounded by newpos */
+  pattern_score *po, *pn; /* scores of old & new pattern */
+  int *sb = bscore->scores[0][0], *sw = bscore->scores[1][0]; /* point scores */
+  int piece = remove ? -(role+1) : role+1; /* delta of piece on newpos */
   int db, dw; /* delta of score of black & white */
-  int x0, y0, k, x, y, i; /* iteration variables */
-  int line; /* line 0~3 */
+  int g, i, k; /* iteration variables */
+  /* iterate each group containing or bounded by newpos */
+  for (k=0; k<pg->n; k++) {
+    g = pg->group[k];
+    /* update pattern */
+    po = &pattern_table[bscore->pattern[g]];
+    bscore->pattern[g] += piece*pg->weight[k];
+    pn = &pattern_table[bscore->pattern[g]];
+    threat_delta(bscore, g, po-pattern_table, pn-pattern_table);
+    /* apply differences to total scores */
+    bscore->totalscore[0] += pn->score[0] - po->score[0];
+    bscore->totalscore[1] += pn->score[1] - po->score[1];
+    /* calculate differences of point scores */
+    db = pn->scorep[0] - po->scorep[0];
+    dw = pn->scorep[1] - po->scorep[1];
+    /* apply differences to points in the group */
+    for (i=0; i<5; i++) {
+      sb[group_point[g][i]] += db;
+      sw[group_point[g][i]] += dw;
+    }
+  }
+}
+
+#if AI_AVX2
+
+/* nonzero if AVX2 kernels are used, set by simd_prepare */
+static int use_avx2;
+
+/* score all groups on board, AVX2 version of score_board_scalar */
+/* 8 adjacent groups in a row are scored at once */
+__attribute__((target("avx2")))
+static void score_board_avx2(board_t board, board_score *bscore) {
+  const int *table = (const int*)pattern_table; /* 4 ints per pattern */
+  pattern_score *ps; /* scores of the pattern */
+  char *points = board[0]; /* board as array of x*BOARD_MAX+y */
+  int *sb = bscore->scores[0][0], *sw = bscore->scores[1][0]; /* point scores */
+  /* board with a free margin of 1 point, so bounding points off the */
+  /* board can be loaded (their pattern is in group_border) */
+  char padded[BOARD_MAX+2][BOARD_MAX+2];
+  __m256i pattern, b, sp0, sp1, tb, tw; /* lanes of 8 groups */
+  __m128i p16;
+  int *p0, *p1;
+  int line, x0, y0, ny, g, i, x, y; /* iteration variables */
+  int tmp;
+  /* clear fields */
+  memset(bscore, 0, sizeof(board_score));
+  memset(padded, I_FREE, sizeof(padded));
+  for (x=0; x<BOARD_W; x++)
+    memcpy(&padded[x+1][1], board[x], BOARD_H);
+  tb = tw = _mm256_setzero_si256();
   /* iterate each line */
-  for (line=0; line<4; line++)
-    /* iterate each group containing newpos */
-    for (
-        x0=newpos->x-groupdim[line][2], y0=newpos->y-groupdim[line][3], k=0;
-        k<5; x0-=linearr[line][0], y0-=linearr[line][1], k++
-        )
-      /* valid groups */
-      if (x0>=0 && x0<groupdim[line][0] &&
-          y0>=0 && y0<groupdim[line][1])
-      {
-        /* judge direction */
-        switch (line) {
-          case 0: gs = &bscore->vertical[x0][y0]; break;
-          case 1: gs = &bscore->horizontal[x0][y0]; break;
-          case 2: gs = &bscore->backslash[x0][y0]; break;
-          case 3: gs = &bscore->slash[x0][y0]; break;
+  for (line=0; line<4; line++) {
+    ny = BOARD_H-groupdim[line][1];
+    /* iterate each row of groups */
+    for (x0=0; x0<BOARD_W-groupdim[line][0]; x0++) {
+      g = group_row[line][x0];
+      /* groups y0~y0+7 have points on y~y+7 of the same rows */
+      for (y0=0; y0+8<=ny; y0+=8) {
+        /* encode pieces and bounding points */
+        pattern = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i*)&group_border[g+y0]));
+        for (
+            i=-1, x=x0+groupdim[line][2]-linearr[line][0], y=y0+groupdim[line][3]-linearr[line][1];
+            i<6; i++, x+=linearr[line][0], y+=linearr[line][1]
+            )
+        {
+          b = _mm256_cvtepi8_epi32(_mm_loadl_epi64((__m128i*)&padded[x+1][y+1]));
+          pattern = _mm256_add_epi32(pattern, _mm256_mullo_epi32(b,
+              _mm256_set1_epi32(pattern_weight[i<0 ? BOUND_LOW : i<5 ? i : BOUND_HIGH])));
         }
-        /* process board scores */
-        /* acquire old values */
-        db = gs->score[0];
-        dw = gs->score[1];
-        /* update piece count */
-        gs->npiece[role] += remove?-1:1;
-        /* calculate differences */
-        db = (gs->score[0] = score_by_count(gs->npiece[0], gs->npiece[1], 1)) - db;
-        dw = (gs->score[1] = score_by_count(gs->npiece[1], gs->npiece[0], 1)) - dw;
-        /* apply differences to total scores */
-        bscore->totalscore[0] += db;
-        bscore->totalscore[1] += dw;
-        /* process point scores */
-        /* acquire old values */
-        db = gs->scorep[0];
-        dw = gs->scorep[1];
-        /* calculate differences */
-        db = (gs->scorep[0] = score_by_count(gs->npiece[0], gs->npiece[1], 0)) - db;
-        dw = (gs->scorep[1] = score_by_count(gs->npiece[1], gs->npiece[0], 0)) - dw;
-        /* apply differences to points in the group */
+        /* record patterns */
+        p16 = _mm_packus_epi32(_mm256_castsi256_si128(pattern), _mm256_extracti128_si256(pattern, 1));
+        _mm_storeu_si128((__m128i*)&bscore->pattern[g+y0], p16);
+        /* look up scores */
+        pattern = _mm256_slli_epi32(pattern, 2);
+        tb = _mm256_add_epi32(tb, _mm256_i32gather_epi32(table+0, pattern, 4));
+        tw = _mm256_add_epi32(tw, _mm256_i32gather_epi32(table+1, pattern, 4));
+        sp0 = _mm256_i32gather_epi32(table+2, pattern, 4);
+        sp1 = _mm256_i32gather_epi32(table+3, pattern, 4);
+        /* update point scores */
         for (
             i=0, x=x0+groupdim[line][2], y=y0+groupdim[line][3];
             i<5; i++, x+=linearr[line][0], y+=linearr[line][1]
             )
         {
-          bscore->scores[0][x][y] += db;
-          bscore->scores[1][x][y] += dw;
+          p0 = &bscore->scores[0][x][y];
+          p1 = &bscore->scores[1][x][y];
+          _mm256_storeu_si256((__m256i*)p0, _mm256_add_epi32(_mm256_loadu_si256((__m256i*)p0), sp0));
+          _mm256_storeu_si256((__m256i*)p1, _mm256_add_epi32(_mm256_loadu_si256((__m256i*)p1), sp1));
         }
       }
+      /* remaining groups of the row */
+      for (; y0<ny; y0++) {
+        tmp = group_pattern(points, g+y0);
+        bscore->pattern[g+y0] = tmp;
+        ps = &pattern_table[tmp];
+        bscore->totalscore[0] += ps->score[0];
+        bscore->totalscore[1] += ps->score[1];
+        for (i=0; i<5; i++) {
+          sb[group_point[g+y0][i]] += ps->scorep[0];
+          sw[group_point[g+y0][i]] += ps->scorep[1];
+        }
+      }
+    }
+  }
+  /* sum up board scores */
+  tb = _mm256_hadd_epi32(tb, tw);
+  tb = _mm256_hadd_epi32(tb, tb);
+  bscore->totalscore[0] += _mm256_extract_epi32(tb, 0) + _mm256_extract_epi32(tb, 4);
+  bscore->totalscore[1] += _mm256_extract_epi32(tb, 1) + _mm256_extract_epi32(tb, 5);
 }
 
-/* find up to num points with highest scores */
+/* update board_score struct by difference, AVX2 version of score_delta_scalar */
+/* all 4 scores of a pattern are taken as a vector */
+/* point scores are updated by a running sum along each line */
+__attribute__((target("avx2")))
+static void score_delta_avx2(board_score *bscore, pos *newpos, int role, int remove) {
+  point_group *pg = &point_groups[newpos->x*BOARD_MAX+newpos->y]; /* groups containing or bounded by newpos */
+  int *sb = bscore->scores[0][0], *sw = bscore->scores[1][0]; /* point scores */
+  int piece = remove ? -(role+1) : role+1; /* delta of piece on newpos */
+  __m128i d[POINT_GROUPS]; /* delta of scores of each group */
+  __m128i total, sum; /* delta of board scores, running sum of point scores */
+  unsigned short *pattern; /* pattern of a group */
+  unsigned short *gp; /* points of a group */
+  int line, m, step, k, j; /* iteration variables */
+  /* update patterns and look up differences of scores */
+  total = _mm_setzero_si128();
+  for (k=0; k<pg->n; k++) {
+    pattern = &bscore->pattern[pg->group[k]];
+    d[k] = _mm_sub_epi32(
+        _mm_load_si128((__m128i*)&pattern_table[*pattern+piece*pg->weight[k]]),
+        _mm_load_si128((__m128i*)&pattern_table[*pattern]));
+    threat_delta(bscore, pg->group[k], *pattern, *pattern+piece*pg->weight[k]);
+    *pattern += piece*pg->weight[k];
+    total = _mm_add_epi32(total, d[k]);
+  }
+  /* apply differences to total scores */
+  bscore->totalscore[0] += _mm_cvtsi128_si32(total);
+  bscore->totalscore[1] += _mm_extract_epi32(total, 1);
+  /* groups of a line are consecutive windows, covering m+4 points */
+  /* point j of them is in groups j-4~j (other groups are only bounded */
+  /* by newpos, and have no points outside the windows) */
+  for (line=0, k=0; line<4; k+=m, line++) {
+    m = pg->nline[line];
+    if (!m)
+      continue;
+    gp = group_point[pg->group[k]];
+    step = gp[1]-gp[0];
+    sum = _mm_setzero_si128();
+    for (j=0; j<m+4; j++) {
+      /* window enters */
+      if (j<m)
+        sum = _mm_add_epi32(sum, d[k+j]);
+      /* window leaves */
+      if (j>=5)
+        sum = _mm_sub_epi32(sum, d[k+j-5]);
+      sb[gp[0]+j*step] += _mm_extract_epi32(sum, 2);
+      sw[gp[0]+j*step] += _mm_extract_epi32(sum, 3);
+    }
+  }
+}
+
+#endif /* AI_AVX2 */
+
+/* select kernels supported by the CPU */
+static void simd_prepare() {
+#if AI_AVX2
+  use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+/* score all groups on board using board_score struct */
+static void score_board_by_struct(board_t board, board_score *bscore) {
+#if AI_AVX2
+  if (use_avx2)
+    score_board_avx2(board, bscore);
+  else
+#endif
+    score_board_scalar(board, bscore);
+  threat_board(bscore);
+  if (nnue_enabled)
+    nnue_refresh(&bscore->acc, board);
+}
+
+/* update board_score struct by difference */
+static void score_struct_delta(board_score *bscore, pos *newpos, int role, int remove) {
+#if AI_AVX2
+  if (use_avx2)
+    score_delta_avx2(bscore, newpos, role, remove);
+  else
+#endif
+    score_delta_scalar(bscore, newpos, role, remove);
+  if (nnue_enabled)
+    nnue_update(&bscore->acc, newpos->x, newpos->y, role, remove);
+}
+
+/* mask of candidate points in column i */
+/* points near pieces, or all points on an empty board */
+#define BB_CANDIDATES(bb, i, size) \
+    (((bb)->npiece ? BB_NEAR(bb, i) : ~0u) & ((1u<<(size))-1))
+
+/* insert a point into the records of max scores (for find_max_points) */
+/* equal scores are kept in the order of insertion */
+static inline void top_insert(int *maxscores, pos *posarr, int num, int score, int x, int y) {
+  int k;
+  /* insertion sort */
+  for (k=num-1; k>0 && score>maxscores[k-1]; k--) {
+    maxscores[k] = maxscores[k-1];
+    posarr[k] = posarr[k-1];
+  }
+  maxscores[k] = score;
+  posarr[k].x = x;
+  posarr[k].y = y;
+}
+
+/* find up to num free candidates not excluded with highest scores */
 /* scores: scores of each points on board */
-/* posarr is used to receive up to num points with scores in descending order */
+/* exclude: masks of points to be skipped in each column */
+/* posarr and maxscores receive points with scores in descending order */
 /* return value is the actual number of points received */
-static int find_max_points(int scores[BOARD_W][BOARD_H], board_t board, int role, pos *posarr, int num) {
-  int i, j, k; /* iteration variables */
-  int maxscores[64] = {0}; /* record of max scores */
+/* size: board size */
+BOARD_INLINE int top_kernel(int scores[BOARD_MAX][BOARD_MAX], bitboard *bb, uint32_t *exclude, pos *posarr, int *maxscores, int num, const int size) {
+  int i, j; /* iteration variables */
   int score; /* score of a point */
-  pos p; /* position */
+  uint32_t free; /* mask of free points in a column */
   int n = 0; /* record of num of actually obtained points  */
-  /* iterate each point */
-  for (i=0; i<BOARD_W; i++)
-    for (j=0; j<BOARD_H; j++) {
+  /* iterate each free point */
+  for (i=0; i<size; i++)
+    for (
+        free = ~(bitboard_column(bb, i) | exclude[i]) & BB_CANDIDATES(bb, i, size);
+        free; free &= free-1
+        ) {
+      j = __builtin_ctz(free);
       score = scores[i][j];
-      /* if the score is greater than the minimum in record*/
-      if (score>maxscores[num-1] && board[i][j] == I_FREE) {
-        p.x = i;
-        p.y = j;
-        /* if the position is not banned, add to list */
-        if (role == ROLE_WHITE || !checkban(board, &p)) {
-          /* insertion sort */
-          for (k=num-1; score>maxscores[k-1] && k>0; k--) {
-            maxscores[k] = maxscores[k-1];
-            posarr[k] = posarr[k-1];
-          }
-          maxscores[k] = score;
-          posarr[k] = p;
+      /* if the score is greater than the minimum in record, add to list */
+      if (score>maxscores[num-1]) {
+        top_insert(maxscores, posarr, num, score, i, j);
+        n++;
+      }
+    }
+  /* normalize return value */
+  if (n>num) n = num;
+  return n;
+}
+
+/* specialized instances of top_kernel */
+static int top_points_scalar(int scores[BOARD_MAX][BOARD_MAX], bitboard *bb, uint32_t *exclude, pos *posarr, int *maxscores, int num) {
+  return BOARD_DISPATCH(top_kernel, scores, bb, exclude, posarr, maxscores, num);
+}
+
+#if AI_AVX2
+
+/* AVX2 version of top_kernel */
+/* 8 points of a column are compared with the minimum in record at once */
+/* and only points passing the test are inserted */
+BOARD_INLINE __attribute__((target("avx2")))
+int top_kernel_avx2(int scores[BOARD_MAX][BOARD_MAX], bitboard *bb, uint32_t *exclude, pos *posarr, int *maxscores, int num, const int size) {
+  int i, j, j0; /* iteration variables */
+  int score; /* score of a point */
+  uint32_t free; /* mask of free points in a column */
+  unsigned int pass; /* mask of points greater than the minimum */
+  __m256i lanes, v;
+  int n = 0; /* record of num of actually obtained points  */
+  lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  /* iterate each column */
+  for (i=0; i<size; i++) {
+    free = ~(bitboard_column(bb, i) | exclude[i]) & BB_CANDIDATES(bb, i, size);
+    /* iterate each 8 points, points beyond size are not loaded */
+    for (j0=0; j0<size; j0+=8) {
+      if (!(free >> j0 & 0xff))
+        continue;
+      v = _mm256_maskload_epi32(&scores[i][j0],
+          _mm256_cmpgt_epi32(_mm256_set1_epi32(size-j0), lanes));
+      v = _mm256_cmpgt_epi32(v, _mm256_set1_epi32(maxscores[num-1]));
+      pass = _mm256_movemask_ps(_mm256_castsi256_ps(v)) & free >> j0;
+      /* insert passed points, the minimum may rise meanwhile */
+      for (; pass; pass &= pass-1) {
+        j = j0+__builtin_ctz(pass);
+        score = scores[i][j];
+        if (score>maxscores[num-1]) {
+          top_insert(maxscores, posarr, num, score, i, j);
           n++;
         }
       }
     }
+  }
   /* normalize return value */
   if (n>num) n = num;
   return n;
 }
 
+/* specialized instances of top_kernel_avx2 */
+__attribute__((target("avx2")))
+static int top_points_avx2(int scores[BOARD_MAX][BOARD_MAX], bitboard *bb, uint32_t *exclude, pos *posarr, int *maxscores, int num) {
+  return BOARD_DISPATCH(top_kernel_avx2, scores, bb, exclude, posarr, maxscores, num);
+}
+
+#endif /* AI_AVX2 */
+
+/* find up to num points with highest scores */
+/* scores: scores of each points on board */
+/* posarr is used to receive up to num points with scores in descending order */
+/* return value is the actual number of points received */
+/* only points near pieces are candidates, see bitboard.h */
+/* for black, points known to be banned in ban map bm are excluded, other */
+/* points are checked only among the selected points, and the selection */
+/* is repeated without them if any is found banned */
+static int find_max_points(int scores[BOARD_MAX][BOARD_MAX], padboard_t board, bitboard *bb, banmap *bm, int role, pos *posarr, int num) {
+  uint32_t banned[BOARD_MAX] = {0}; /* banned points found */
+  uint32_t allowed[BOARD_MAX] = {0}; /* points checked not to be banned */
+  int maxscores[MAXPOS_LEN]; /* record of max scores */
+  int i, n, found;
+  if (role == ROLE_BLACK)
+    for (i=0; i<BOARD_W; i++)
+      banned[i] = BANMAP_KNOWN(bm, i) & BANMAP_BANNED(bm, i);
+  do {
+    memset(maxscores, 0, num*sizeof(int));
+#if AI_AVX2
+    if (use_avx2)
+      n = top_points_avx2(scores, bb, banned, posarr, maxscores, num);
+    else
+#endif
+      n = top_points_scalar(scores, bb, banned, posarr, maxscores, num);
+    /* white is never banned */
+    if (role == ROLE_WHITE)
+      break;
+    /* check selected points */
+    found = 0;
+    for (i=0; i<n; i++) {
+      if (allowed[posarr[i].x] >> posarr[i].y & 1)
+        continue;
+      if (banmap_check(bm, board, posarr[i].x, posarr[i].y)) {
+        banned[posarr[i].x] |= 1u << posarr[i].y;
+        found = 1;
+      } else
+        allowed[posarr[i].x] |= 1u << posarr[i].y;
+    }
+  } while (found);
+  return n;
+}
+
+/* place or remove a piece of role on the board */
+/* hash state, bitboard and ban map are updated as well */
+/* near and bans save candidates and ban status changed by placement, */
+/* to be restored on removal */
+static inline void apply_move(hash_state *hash, padboard_t board, bitboard *bb, banmap *bm, uint32_t *near, uint32_t *bans, pos *p, int role, int remove) {
+  board[PADBOARD_INDEX(p->x, p->y)] = remove ? I_FREE : role+1;
+  hash_apply_delta(hash, p->x, p->y, role+1);
+  if (remove) {
+    banmap_remove(bm, p->x, bans);
+    bitboard_remove(bb, p->x, p->y, role, near);
+  } else {
+    banmap_place(bm, p->x, p->y, bans);
+    bitboard_place(bb, p->x, p->y, role, near);
+  }
+}
+
+/* find a point where role completes five, other than skip (if not null) */
+/* return value is nonzero if found, and *p receives the point */
+static int threat_find(board_score *bscore, int role, pos *skip, pos *p) {
+  int i, j;
+  uint32_t m;
+  for (i=0; i<BOARD_W; i++)
+    for (m=bscore->winmask[role][i]; m; m &= m-1) {
+      j = __builtin_ctz(m);
+      if (skip && skip->x == i && skip->y == j)
+        continue;
+      p->x = i;
+      p->y = j;
+      return 1;
+    }
+  return 0;
+}
+
+/* nonzero if role placing on point index of livemask makes fours */
+/* completed by two different points */
+/* (threes of a line may share both free points, as in *__***) */
+static int threat_live(board_score *bscore, int role, int index) {
+  point_group *pg = &point_groups[index];
+  pattern_threat *pt;
+  int k, g, other, first = -1;
+  for (k=0; k<pg->n; k++) {
+    g = pg->group[k];
+    pt = &threat_table[bscore->pattern[g]];
+    if (pt->type[role] != THREAT_THREE)
+      continue;
+    /* the other free point completes five, unless index only bounds g */
+    if (group_point[g][pt->slot[0]] == index)
+      other = group_point[g][pt->slot[1]];
+    else if (group_point[g][pt->slot[1]] == index)
+      other = group_point[g][pt->slot[0]];
+    else
+      continue;
+    if (first >= 0 && other != first)
+      return 1;
+    first = other;
+  }
+  return 0;
+}
+
+/* find a point where role makes two fours at once */
+/* for black, banned points are not counted */
+/* return value is nonzero if found, and *p receives the point */
+static int threat_find_live(board_score *bscore, padboard_t board, banmap *bm, int role, pos *p) {
+  int i, j;
+  uint32_t m;
+  for (i=0; i<BOARD_W; i++)
+    for (m=bscore->livemask[role][i]; m; m &= m-1) {
+      j = __builtin_ctz(m);
+      if (!threat_live(bscore, role, i*BOARD_MAX+j) ||
+          (role == ROLE_BLACK && banmap_check(bm, board, i, j)))
+        continue;
+      p->x = i;
+      p->y = j;
+      return 1;
+    }
+  return 0;
+}
+
 /* game tree searching with alpha beta cutting */
 static int alphabeta(
-    HASHVALUE hash, /* hash value of current board */
-    int move, /* current move count */
+    hash_state *hash, /* hash state of current board */
     int role, /* current role */
     int depth, /* max recursion depth */
     int width, /* max search width */
     int alpha, /* alpha value */
     int beta, /* beta value */
-    board_t board, /* current board */
+    padboard_t board, /* current board */
+    bitboard *bb, /* current bitboard */
+    banmap *bm, /* current ban map */
     board_score *bscore,
-    pos *newpos, /* newest position */
     int *signaled /* if signaled, stop searching */
     )
 {
 
-  int i, n, t;
+  int i, j, k, n, t;
   /* this is alpha node by default */
   hash_type type = hash_alpha;
   pos maxpos[MAXPOS_LEN];
+  pos hashpos; /* best move from hash table */
+  pos best; /* best move of this node */
+  int generated; /* nonzero if candidate points are generated */
+  uint32_t near[BITBOARD_NEAR*2+1]; /* candidates saved by apply_move */
+  uint32_t bans[BANMAP_SAVED]; /* ban status saved by apply_move */
+  int forced; /* nonzero if the opponent's five must be blocked */
+  pos forcepos; /* point to block */
+
+  STAT_INC(stat_node);
 
   /* judge if lose */
-  i = judge(board, newpos);
   /* if lose, return negative infinity */
-  if (i>=0 && i!=role)
+  if (bscore->nfive[role^1])
     return -SCORE_INF;
 
+  /* win by completing five */
+  if (bscore->nwin[role])
+    return SCORE_INF;
+
+  /* the opponent completes five next unless blocked */
+  forced = threat_find(bscore, role^1, 0, &forcepos);
+  if (forced) {
+    /* lose if there are two points or the point is banned */
+    if (bscore->nwin[role^1] > 1 ||
+        (role == ROLE_BLACK && banmap_check(bm, board, forcepos.x, forcepos.y)))
+      return -SCORE_INF;
+  }
+
+  /* win by making two fours at once, if the opponent has no three to */
+  /* answer with a four */
+  else if (bscore->nlive[role] && !bscore->nthree[role^1] &&
+      threat_find_live(bscore, board, bm, role, &forcepos))
+    return SCORE_INF;
+
   /* leaf node, return score of the board */
   if (depth<=0)
-    return bscore->totalscore[role];
+    return nnue_enabled ? nnue_evaluate(&bscore->acc, role) : bscore->totalscore[role];
 
   /* look up hash table */
   /* if node already calculated, return stored value */
-  if (hashtable_lookup(hash, move, depth, alpha, beta, &t))
+  if (hashtable_lookup(hash, depth, alpha, beta, &t, &hashpos))
     return t;
 
-  /* find points with highest scores */
-  n = find_max_points(bscore->scores[role], board, role, maxpos, width);
+  /* search the best move from hash table first */
+  /* candidate points are generated only if it does not cut */
+  n = 0;
+  generated = 0;
+  if (forced) {
+    /* blocking is the only move */
+    maxpos[n++] = forcepos;
+    generated = 1;
+  } else if (hashpos.x >= 0 && !bitboard_occupied(bb, hashpos.x, hashpos.y) &&
+      (role == ROLE_WHITE || !banmap_check(bm, board, hashpos.x, hashpos.y)))
+    maxpos[n++] = hashpos;
+  best.x = best.y = -1;
 
   /* search on these n points recursively */
-  for (i=0; i<n; i++) {
+  for (i=0; ; i++) {
+
+    /* generate candidate points after the hash move */
+    if (i>=n) {
+      if (generated) break;
+      generated = 1;
+      /* find points with highest scores */
+      t = find_max_points(bscore->scores[role], board, bb, bm, role, maxpos+n, width);
+      /* remove the hash move which is already searched */
+      for (j=k=n; j<n+t; j++)
+        if (!n || maxpos[j].x != maxpos[0].x || maxpos[j].y != maxpos[0].y)
+          maxpos[k++] = maxpos[j];
+      n = k<width ? k : width;
+      if (i>=n) break;
+    }
 
     /* update scores by difference */
     score_struct_delta(bscore, &maxpos[i], role, 0);
 
     /* place new piece and calculate hash by difference */
-    hash = hash_board_apply_delta(hash, board, maxpos[i].x, maxpos[i].y, role+1, 0);
+    apply_move(hash, board, bb, bm, near, bans, &maxpos[i], role, 0);
 
     do {
 
       /* PVS search */
       if (i>1 && alpha+1<beta) {
         /* probe with beta = alpha+1 */
-        t = -alphabeta(hash, move+1, role^1, depth-1, width, -alpha-1, -alpha, board, bscore, &maxpos[i], signaled);
+        t = -alphabeta(hash, role^1, depth-1, width, -alpha-1, -alpha, board, bb, bm, bscore, signaled);
         if (t<=alpha || t>=beta) {
           /* no need to search further */
           break;
@@ -356,36 +1059,39 @@ static int alphabeta(
       }
     
       /* recursive search */
-      t = -alphabeta(hash, move+1, role^1, depth-1, width, -beta, -alpha, board, bscore, &maxpos[i], signaled);
+      t = -alphabeta(hash, role^1, depth-1, width, -beta, -alpha, board, bb, bm, bscore, signaled);
 
     } while (0);
 
     /* remove new piece and calculate hash by difference */
-    hash = hash_board_apply_delta(hash, board, maxpos[i].x, maxpos[i].y, role+1, 1);
+    apply_move(hash, board, bb, bm, near, bans, &maxpos[i], role, 1);
 
     /* revert scores */
     score_struct_delta(bscore, &maxpos[i], role, 1);
     
     /* time out, stop searching */
-    if (signaled && *signaled)
+    if (signaled && __atomic_load_n(signaled, __ATOMIC_RELAXED))
       return 0;
 
     /* update alpha */
     if (t>alpha) {
       type = hash_exact;
       alpha = t;
+      best = maxpos[i];
     }
 
     /* beta cutting */
     if (alpha>=beta) {
       type = hash_beta;
+      STAT_INC(stat_cutoff);
+      if (i==0) STAT_INC(stat_cutoff_first);
       break;
     }
 
   }
 
-  /* store value to hash table */
-  hashtable_store(hash, move, depth, type, alpha);
+  /* store value and best move to hash table */
+  hashtable_store(hash, depth, type, alpha, &best);
 
   /* return alpha value as score of node */
   return alpha;
@@ -398,7 +1104,9 @@ static void* negamax_thread_routine(void *parameter) {
   negamax_param *param = parameter;
   int i, t;
   int beta = SCORE_INF;
-  HASHVALUE hash = param->hash;
+  hash_state *hash = &param->hash;
+  uint32_t near[BITBOARD_NEAR*2+1]; /* candidates saved by apply_move */
+  uint32_t bans[BANMAP_SAVED]; /* ban status saved by apply_move */
 
 #if AI_DEBUG
   /* print depth for debug */
@@ -411,14 +1119,14 @@ static void* negamax_thread_routine(void *parameter) {
     score_struct_delta(&param->bs, &param->maxpos[i], param->role, 0);
 
     /* place new piece and calculate hash by difference */
-    hash = hash_board_apply_delta(hash, param->board, param->maxpos[i].x, param->maxpos[i].y, param->role+1, 0);
+    apply_move(hash, param->board, &param->bb, &param->bm, near, bans, &param->maxpos[i], param->role, 0);
 
     do {
 
       /* PVS search */
       if (i>1 && *param->alpha+1<beta) {
         /* probe with beta = alpha+1 */
-        t = -alphabeta(hash, param->move+1, param->role^1, param->depth-1, param->width, -*param->alpha-1, -*param->alpha, param->board, &param->bs, &param->maxpos[i], param->signaled);
+        t = -alphabeta(hash, param->role^1, param->depth-1, param->width, -*param->alpha-1, -*param->alpha, param->board, &param->bb, &param->bm, &param->bs, param->signaled);
         if (t<=*param->alpha || t>=beta) {
           /* no need to search further */
           break;
@@ -426,18 +1134,18 @@ static void* negamax_thread_routine(void *parameter) {
       }
     
       /* recursive search */
-      t = -alphabeta(hash, param->move+1, param->role^1, param->depth-1, param->width, -beta, -*param->alpha, param->board, &param->bs, &param->maxpos[i], param->signaled);
+      t = -alphabeta(hash, param->role^1, param->depth-1, param->width, -beta, -*param->alpha, param->board, &param->bb, &param->bm, &param->bs, param->signaled);
 
     } while (0);
 
     /* remove new piece and calculate hash by difference */
-    hash = hash_board_apply_delta(hash, param->board, param->maxpos[i].x, param->maxpos[i].y, param->role+1, 1);
+    apply_move(hash, param->board, &param->bb, &param->bm, near, bans, &param->maxpos[i], param->role, 1);
 
     /* revert scores */
     score_struct_delta(&param->bs, &param->maxpos[i], param->role, 1);
 
     /* time out, stop searching */
-    if (param->signaled && *param->signaled) {
+    if (param->signaled && __atomic_load_n(param->signaled, __ATOMIC_RELAXED)) {
       *param->scores[i] = -SCORE_INF;
       break;
     }
@@ -472,24 +1180,223 @@ static void* negamax_thread_routine(void *parameter) {
 
 }
 
-/* timing thread */
-static void* signal_thread_routine(void *parameter) {
-  signal_param *param = parameter;
-  unsigned long long inittime = param->inittime;
-  while (pai_time() - inittime < MAX_TIME) {
-    /* search already finished, stop timing */
-    if (*param->exit) return 0;
-    usleep(100000);
+/* worker thread of the pool */
+/* parameter: thread number */
+static void* pool_routine(void *parameter) {
+  pool_job *job;
+  uint64_t c;
+  unsigned gen = 0;
+  int spin;
+  /* use counters of this thread */
+  stats_bind((int)(intptr_t)parameter+1);
+  for (;;) {
+    /* wait for a new generation */
+    for (spin=0; spin<POOL_SPIN; spin++) {
+      if (POOL_GEN(__atomic_load_n(&pool.claim, __ATOMIC_ACQUIRE)) != gen ||
+          __atomic_load_n(&pool.exit, __ATOMIC_ACQUIRE))
+        break;
+      POOL_PAUSE();
+    }
+    if (spin == POOL_SPIN) {
+      pthread_mutex_lock(&pool.mutex);
+      while (POOL_GEN(__atomic_load_n(&pool.claim, __ATOMIC_ACQUIRE)) == gen &&
+          !__atomic_load_n(&pool.exit, __ATOMIC_ACQUIRE))
+        pthread_cond_wait(&pool.work, &pool.mutex);
+      pthread_mutex_unlock(&pool.mutex);
+    }
+    if (__atomic_load_n(&pool.exit, __ATOMIC_ACQUIRE))
+      break;
+    gen = POOL_GEN(__atomic_load_n(&pool.claim, __ATOMIC_ACQUIRE));
+    /* claim jobs of this generation */
+    /* the number of jobs is read from the same word as the generation, */
+    /* as the caller may be posting the next batch */
+    for (;;) {
+      c = __atomic_load_n(&pool.claim, __ATOMIC_ACQUIRE);
+      if (POOL_GEN(c) != gen || POOL_NEXT(c) >= POOL_NJOBS(c))
+        break;
+      if (!__atomic_compare_exchange_n(&pool.claim, &c, c+1, 0,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        continue;
+      job = &pool.jobs[POOL_NEXT(c)];
+      job->routine(job->parameter);
+      /* the last job wakes the caller */
+      if (!__atomic_sub_fetch(&pool.pending, 1, __ATOMIC_ACQ_REL)) {
+        pthread_mutex_lock(&pool.mutex);
+        pthread_cond_broadcast(&pool.done);
+        pthread_mutex_unlock(&pool.mutex);
+      }
+    }
   }
-  /* set signaled state */
-  *param->signaled = 1;
   return 0;
 }
 
+/* run jobs on the pool and wait for them */
+/* *signaled is set if the deadline (in pai_time) is reached */
+static void pool_run(pool_job *jobs, int n, int *signaled, unsigned long long deadline) {
+  struct timespec ts;
+  unsigned long long now;
+  uint64_t c;
+  /* all jobs of the last batch are claimed, so no worker reads jobs */
+  memcpy(pool.jobs, jobs, n*sizeof(pool_job));
+  __atomic_store_n(&pool.pending, n, __ATOMIC_RELAXED);
+  /* publish the batch */
+  pthread_mutex_lock(&pool.mutex);
+  c = __atomic_load_n(&pool.claim, __ATOMIC_RELAXED);
+  __atomic_store_n(&pool.claim, POOL_CLAIM(POOL_GEN(c)+1, n), __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&pool.work);
+  /* wait until finished, stopping the search at the deadline */
+  while (__atomic_load_n(&pool.pending, __ATOMIC_ACQUIRE)) {
+    now = pai_time();
+    if (__atomic_load_n(signaled, __ATOMIC_RELAXED) || now >= deadline) {
+      __atomic_store_n(signaled, 1, __ATOMIC_RELAXED);
+      pthread_cond_wait(&pool.done, &pool.mutex);
+      continue;
+    }
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (deadline-now)/1000;
+    ts.tv_nsec += (deadline-now)%1000*1000000;
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&pool.done, &pool.mutex, &ts);
+  }
+  pthread_mutex_unlock(&pool.mutex);
+}
+
+/* stop threads of the pool */
+static void pool_fini() {
+  int i;
+  pthread_mutex_lock(&pool.mutex);
+  __atomic_store_n(&pool.exit, 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&pool.work);
+  pthread_mutex_unlock(&pool.mutex);
+  for (i=0; i<pool.nthreads; i++)
+    pthread_join(pool.tid[i], 0);
+  pool.nthreads = 0;
+  free(pool_param);
+  pool_param = 0;
+}
+
+/* create threads of the pool if not created */
+/* return value is nonzero for success */
+static int pool_init() {
+  pthread_attr_t attr;
+#ifdef __linux__
+  cpu_set_t allowed, set;
+  int cpu = -1;
+#endif
+  int i, n;
+  if (pool.nthreads)
+    return 1;
+  if (posix_memalign((void **)&pool_param, 64, pool_size*sizeof(negamax_param)))
+    return 0;
+  __atomic_store_n(&pool.claim, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&pool.exit, 0, __ATOMIC_RELAXED);
+#ifdef __linux__
+  if (pool_pin && sched_getaffinity(0, sizeof(cpu_set_t), &allowed))
+    CPU_ZERO(&allowed);
+#endif
+  for (n=0; n<pool_size; n++) {
+    pthread_attr_init(&attr);
+#ifdef __linux__
+    /* pin to the next allowed processor, wrapping around */
+    if (pool_pin && CPU_COUNT(&allowed)) {
+      for (i=0; i<CPU_SETSIZE; i++) {
+        cpu = (cpu+1) % CPU_SETSIZE;
+        if (CPU_ISSET(cpu, &allowed))
+          break;
+      }
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &set);
+    }
+#endif
+    i = pthread_create(&pool.tid[n], &attr, pool_routine, (void *)(intptr_t)n);
+    pthread_attr_destroy(&attr);
+    if (i)
+      break;
+  }
+  pool.nthreads = n;
+  if (n < pool_size) {
+    pool_fini();
+    return 0;
+  }
+  return 1;
+}
+
+/* prepare root of searching */
+/* scores, hash state, padded board, bitboard and ban map of board are */
+/* calculated, and points to be searched are stored in maxpos, with the */
+/* best point found in previous turns first */
+/* return value is the number of points */
+static int root_prepare(
+    int role, /* current role */
+    int width, /* search width */
+    board_t board, /* current board */
+    hash_state *hash, /* hash state to calculate */
+    padboard_t pb, /* padded board to build */
+    bitboard *bb, /* bitboard to build */
+    banmap *bm, /* ban map to build */
+    board_score *bs, /* board scores to calculate */
+    pos *maxpos /* points with max scores */
+    )
+{
+  int j, k, n, t;
+  pos tmppos;
+
+  /* age entries of previous searches */
+  hashtable_new_search();
+
+  /* calculate scores */
+  score_board_by_struct(board, bs);
+
+  /* calculate hash state of the current board */
+  hash_board(board, hash);
+
+  /* build padded board, bitboard and empty ban map of the current board */
+  padboard_from_board(pb, board);
+  bitboard_from_board(bb, board);
+  banmap_init(bm);
+
+  /* find points with the highest scores */
+  n = find_max_points(bs->scores[role], pb, bb, bm, role, maxpos, width);
+
+  /* search the best point found in previous turns first */
+  hashtable_lookup(hash, 0, -SCORE_INF, SCORE_INF, &t, &tmppos);
+  for (j=1; j<n; j++)
+    if (maxpos[j].x == tmppos.x && maxpos[j].y == tmppos.y) {
+      for (k=j; k>0; k--)
+        maxpos[k] = maxpos[k-1];
+      maxpos[0] = tmppos;
+      break;
+    }
+
+  return n;
+}
+
+/* sort points with score descending */
+static void sort_points(pos *maxpos, int *scores, int n) {
+  int j, k;
+  pos tmppos; /* temp variable for sorting */
+  int tmpscore; /* temp variable for sorting */
+  for (j=1; j<n; j++) {
+    if (scores[j]>scores[j-1]) {
+      tmpscore = scores[j];
+      tmppos = maxpos[j];
+      for (k=j; k>0&&tmpscore>scores[k-1]; k--) {
+        scores[k] = scores[k-1];
+        maxpos[k] = maxpos[k-1];
+      }
+      scores[k] = tmpscore;
+      maxpos[k] = tmppos;
+    }
+  }
+}
+
 /* wrapper of alphabeta */
 /* find the optimal position using alphabeta (multi-threaded) */
 static int negamax_parallel(
-    int move, /* current move count */
     int role, /* current role */
     int depth, /* search depth */
     int width, /* search width */
@@ -498,39 +1405,26 @@ static int negamax_parallel(
     )
 {
 
-  HASHVALUE hash;
+  hash_state hash;
+  padboard_t pb;
+  bitboard bb;
+  banmap bm;
   board_score bs;
   /* initial alpha and beta values */
   int alpha = -SCORE_INF, beta = SCORE_INF;
-  int i, j, k; /* iteration variables */
+  int i; /* iteration variable */
   int n, t;
   pos maxpos[MAXPOS_LEN]; /* points with max scores */
   int scores[MAXPOS_LEN]; /* max scores */
-  pos tmppos; /* temp variable for sorting */
-  int tmpscore; /* temp variable for sorting */
-  negamax_param param[PARALLEL_THREADS]; /* searching thread parameters */
-  pthread_t tid[PARALLEL_THREADS]; /* searching thread ids */
+  negamax_param *param = pool_param; /* searching thread parameters */
+  int nthreads = pool.nthreads; /* number of searching threads */
+  pool_job jobs[AI_THREADS_MAX]; /* jobs of searching threads */
   pthread_mutex_t mutex; /* mutex for sync */
   int signaled = 0; /* timeout flag */
-  int exit = 0; /* exit flag */
-  signal_param sparam; /* signal thread parameter */
-  pthread_t stid; /* signal thread id */
   unsigned long long inittime = pai_time(); /* initial time */
 
-  /* set up signal thread */
-  sparam.inittime = inittime;
-  sparam.signaled = &signaled;
-  sparam.exit = &exit;
-  pthread_create(&stid, 0, signal_thread_routine, &sparam);
-
-  /* calculate scores */
-  score_board_by_struct(board, &bs);
-
-  /* calculate hash value of the current board */
-  hash = hash_board(board);
-
-  /* find points with the highest scores */
-  n = find_max_points(bs.scores[role], board, role, maxpos, width);
+  /* prepare root */
+  n = root_prepare(role, width, board, &hash, pb, &bb, &bm, &bs, maxpos);
 
   /* preset result to current optimal position in case of no result produced by search */
   *result = maxpos[0];
@@ -542,52 +1436,39 @@ static int negamax_parallel(
   while (!signaled && depth<=MAX_DEPTH && width>0) {
 
     /* initialize parameters */
-    for (i=0; i<PARALLEL_THREADS; i++) {
+    for (i=0; i<nthreads; i++) {
       param[i].signaled = &signaled;
       param[i].result = result;
       param[i].alpha = &alpha;
       param[i].mutex = &mutex;
-      param[i].move = move;
       param[i].depth = depth;
       param[i].width = width;
       param[i].role = role;
       param[i].npos = 0;
       param[i].hash = hash;
-      memcpy(param[i].board, board, sizeof(board_t));
+      memcpy(param[i].board, pb, sizeof(padboard_t));
+      memcpy(&param[i].bb, &bb, sizeof(bitboard));
+      memcpy(&param[i].bm, &bm, sizeof(banmap));
       memcpy(&param[i].bs, &bs, sizeof(board_score));
     }
 
     /* assign tasks */
     for (i=0; i<n; i++) {
-      t = i % PARALLEL_THREADS;
+      t = i % nthreads;
       param[t].maxpos[param[t].npos] = maxpos[i];
       param[t].scores[param[t].npos] = &scores[i];
       param[t].npos++;
     }
 
-    /* fork */
-    for (i=0; i<PARALLEL_THREADS; i++) {
-      pthread_create(&tid[i], 0, negamax_thread_routine, &param[i]);
-    }
-
-    /* join */
-    for (i=0; i<PARALLEL_THREADS; i++) {
-      pthread_join(tid[i], 0);
+    /* run on the pool until finished or timed out */
+    for (i=0; i<nthreads; i++) {
+      jobs[i].routine = negamax_thread_routine;
+      jobs[i].parameter = &param[i];
     }
+    pool_run(jobs, nthreads, &signaled, inittime+MAX_TIME);
 
     /* sort points with score descending */
-    for (j=1; j<n; j++) {
-      if (scores[j]>scores[j-1]) {
-        tmpscore = scores[j];
-        tmppos = maxpos[j];
-        for (k=j; k>0&&tmpscore>scores[k-1]; k--) {
-          scores[k] = scores[k-1];
-          maxpos[k] = maxpos[k-1];
-        }
-        scores[k] = tmpscore;
-        maxpos[k] = tmppos;
-      }
-    }
+    sort_points(maxpos, scores, n);
 
     /* continue search only when 1/5 of max time is remaining */
     if (pai_time()-inittime>MAX_TIME/5)
@@ -602,9 +1483,203 @@ static int negamax_parallel(
   /* destroy mutex */
   pthread_mutex_destroy(&mutex);
 
-  /* inform signal thread to exit */
-  exit = 1;
-  pthread_join(stid, 0);
+  /* return alpha value as score of node */
+  return alpha;
+
+}
+
+/*
+ * Lazy SMP
+ *
+ * Every thread searches all points of the root with its own iterative
+ * deepening, and threads share results only through the hash table.
+ * Threads from 1 on search a different point first, so that they fill
+ * the table with different parts of the tree for each other. All
+ * threads deepen by 2 from the same depth like negamax_parallel, so that
+ * every iteration ends on the move of the root side, and the leaf scores
+ * of iterations are comparable. The deepest finished iteration of any
+ * thread gives the result, and thread 0 stops the others when it stops
+ * deepening.
+ *
+ */
+
+/* thread routine for negamax_lazy */
+static void* lazy_thread_routine(void *parameter) {
+
+  negamax_param *param = parameter;
+  int i, k, n, t, depth, alpha;
+  int beta = SCORE_INF;
+  int scores[MAXPOS_LEN]; /* scores of points */
+  pos best, tmppos;
+  hash_state *hash = &param->hash;
+  uint32_t near[BITBOARD_NEAR*2+1]; /* candidates saved by apply_move */
+  uint32_t bans[BANMAP_SAVED]; /* ban status saved by apply_move */
+
+  /* search a different point first */
+  n = param->npos;
+  k = param->id % (n < LAZY_ORDER ? (n > 0 ? n : 1) : LAZY_ORDER);
+  if (k) {
+    tmppos = param->maxpos[k];
+    for (i=k; i>0; i--)
+      param->maxpos[i] = param->maxpos[i-1];
+    param->maxpos[0] = tmppos;
+  }
+
+  /* deepen until stopped or max loop count exceeded */
+  for (depth=param->depth; depth<=MAX_DEPTH && n>0; depth+=2, n-=3) {
+
+#if AI_DEBUG
+    /* print depth for debug */
+    fprintf(stderr, "thread %d depth: %d\n", param->id, depth);
+#endif
+
+    alpha = -SCORE_INF;
+    best = param->maxpos[0];
+
+    for (i=0; i<n; i++) {
+
+      /* update scores by difference */
+      score_struct_delta(&param->bs, &param->maxpos[i], param->role, 0);
+
+      /* place new piece and calculate hash by difference */
+      apply_move(hash, param->board, &param->bb, &param->bm, near, bans, &param->maxpos[i], param->role, 0);
+
+      do {
+
+        /* PVS search */
+        if (i>0 && alpha+1<beta) {
+          /* probe with beta = alpha+1 */
+          t = -alphabeta(hash, param->role^1, depth-1, param->width, -alpha-1, -alpha, param->board, &param->bb, &param->bm, &param->bs, param->signaled);
+          if (t<=alpha || t>=beta) {
+            /* no need to search further */
+            break;
+          }
+        }
+
+        /* recursive search */
+        t = -alphabeta(hash, param->role^1, depth-1, param->width, -beta, -alpha, param->board, &param->bb, &param->bm, &param->bs, param->signaled);
+
+      } while (0);
+
+      /* remove new piece and calculate hash by difference */
+      apply_move(hash, param->board, &param->bb, &param->bm, near, bans, &param->maxpos[i], param->role, 1);
+
+      /* revert scores */
+      score_struct_delta(&param->bs, &param->maxpos[i], param->role, 1);
+
+      /* stopped, discard this iteration */
+      if (__atomic_load_n(param->signaled, __ATOMIC_RELAXED))
+        break;
+
+      /* save score */
+      scores[i] = t;
+
+      /* update alpha */
+      if (t>alpha) {
+        alpha = t;
+        best = param->maxpos[i];
+      }
+
+      /* beta cutting */
+      if (alpha>=beta)
+        break;
+
+    }
+
+    /* stopped */
+    if (__atomic_load_n(param->signaled, __ATOMIC_RELAXED))
+      break;
+
+    /* take the result if it is the deepest */
+    pthread_mutex_lock(param->mutex);
+    if (depth>*param->done) {
+      *param->done = depth;
+      *param->alpha = alpha;
+      *param->result = best;
+    }
+    pthread_mutex_unlock(param->mutex);
+
+    /* sort points with score descending */
+    sort_points(param->maxpos, scores, i < n ? i+1 : n);
+
+    /* continue search only when 1/5 of max time is remaining */
+    if (pai_time()-param->inittime>MAX_TIME/5)
+      break;
+
+  }
+
+  /* thread 0 stops the others */
+  if (param->id == 0)
+    __atomic_store_n(param->signaled, 1, __ATOMIC_RELAXED);
+
+  return 0;
+
+}
+
+/* wrapper of alphabeta */
+/* find the optimal position using alphabeta (Lazy SMP) */
+static int negamax_lazy(
+    int role, /* current role */
+    int depth, /* search depth */
+    int width, /* search width */
+    board_t board, /* current board */
+    pos *result /* pointer to receive the optimal position */
+    )
+{
+
+  hash_state hash;
+  padboard_t pb;
+  bitboard bb;
+  banmap bm;
+  board_score bs;
+  int alpha = -SCORE_INF; /* score of result */
+  int done = 0; /* depth of result */
+  int i, n;
+  pos maxpos[MAXPOS_LEN]; /* points with max scores */
+  negamax_param *param = pool_param; /* searching thread parameters */
+  int nthreads = pool.nthreads; /* number of searching threads */
+  pool_job jobs[AI_THREADS_MAX]; /* jobs of searching threads */
+  pthread_mutex_t mutex; /* mutex for sync */
+  int signaled = 0; /* stop flag */
+  unsigned long long inittime = pai_time(); /* initial time */
+
+  /* prepare root */
+  n = root_prepare(role, width, board, &hash, pb, &bb, &bm, &bs, maxpos);
+
+  /* preset result to current optimal position in case of no result produced by search */
+  *result = maxpos[0];
+
+  /* initialize mutex */
+  pthread_mutex_init(&mutex, 0);
+
+  /* initialize parameters, all points for each thread */
+  for (i=0; i<nthreads; i++) {
+    param[i].signaled = &signaled;
+    param[i].result = result;
+    param[i].alpha = &alpha;
+    param[i].done = &done;
+    param[i].mutex = &mutex;
+    param[i].id = i;
+    param[i].inittime = inittime;
+    param[i].depth = depth;
+    param[i].width = width;
+    param[i].role = role;
+    param[i].npos = n;
+    memcpy(param[i].maxpos, maxpos, n*sizeof(pos));
+    param[i].hash = hash;
+    memcpy(param[i].board, pb, sizeof(padboard_t));
+    memcpy(&param[i].bb, &bb, sizeof(bitboard));
+    memcpy(&param[i].bm, &bm, sizeof(banmap));
+    memcpy(&param[i].bs, &bs, sizeof(board_score));
+    jobs[i].routine = lazy_thread_routine;
+    jobs[i].parameter = &param[i];
+  }
+
+  /* run on the pool until stopped or timed out */
+  pool_run(jobs, nthreads, &signaled, inittime+MAX_TIME);
+
+  /* destroy mutex */
+  pthread_mutex_destroy(&mutex);
 
   /* return alpha value as score of node */
   return alpha;
@@ -652,21 +1727,113 @@ static int ai_callback(
         return ACTION_PLACE;
       default:
         /* call negamax searching function for optimal position */
-        negamax_parallel(move, role, ALPHABETA_DEPTH, ALPHABETA_WIDTH, board, newpos);
+        if ((intptr_t)userdata == AI_TYPE_LAZY_SMP)
+          negamax_lazy(role, ALPHABETA_DEPTH, ALPHABETA_WIDTH, board, newpos);
+        else
+          negamax_parallel(role, ALPHABETA_DEPTH, ALPHABETA_WIDTH, board, newpos);
+        /* dump statistics of this move */
+        if (stats_enabled)
+          stats_dump(move, hashtable_usage());
         return ACTION_PLACE;
     }
   }
   /* cleanup work */
   else if (action == ACTION_CLEANUP) {
+    /* stop threads */
+    pool_fini();
     /* finalize hash table */
     hashtable_fini();
   }
   return 0;
 }
 
+
+/* prototype in ai.h */
+void ai_get_weights(ai_weights weights) {
+  memcpy(weights, eval_weights, sizeof(ai_weights));
+}
+
+/* prototype in ai.h */
+void ai_set_weights(const ai_weights weights) {
+  memcpy(eval_weights, weights, sizeof(ai_weights));
+  pattern_prepare();
+}
+
+/* prototype in ai.h */
+int ai_load_weights(const char *path, ai_weights weights) {
+  FILE *fp;
+  char line[256], name[16], extra[2];
+  char *comment;
+  int i, n, value, lineno = 0, ok = 1;
+  if (!(fp = fopen(path, "r"))) {
+    perror(path);
+    return 0;
+  }
+  while (ok && fgets(line, sizeof(line), fp)) {
+    lineno++;
+    /* strip comment */
+    if ((comment = strchr(line, '#')))
+      *comment = 0;
+    /* skip blank line */
+    n = sscanf(line, "%15s %d %1s", name, &value, extra);
+    if (n == EOF)
+      continue;
+    /* look up name */
+    for (i=0; i<AI_WEIGHT_NUM; i++)
+      if (!strcmp(name, weight_names[i]))
+        break;
+    if (n != 2 || i == AI_WEIGHT_NUM) {
+      fprintf(stderr, "ai: %s:%d: invalid weight\n", path, lineno);
+      ok = 0;
+    }
+    else
+      weights[i] = value;
+  }
+  fclose(fp);
+  return ok;
+}
+
+/* prototype in ai.h */
+void ai_save_weights(FILE *fp, const ai_weights weights) {
+  int i;
+  for (i=0; i<AI_WEIGHT_NUM; i++)
+    fprintf(fp, "%s %d\n", weight_names[i], weights[i]);
+}
+
+/* prototype in ai.h */
+void ai_weights_file(const char *path) {
+  weight_file = path;
+}
+
+/* prototype in ai.h */
+void ai_threads(int n, int pin) {
+  pool_size = n <= 0 ? PARALLEL_THREADS : n > AI_THREADS_MAX ? AI_THREADS_MAX : n;
+  pool_pin = pin;
+}
+
+/* prototype in ai.h */
+int ai_evaluate(board_t board, int role) {
+  board_score bscore;
+  score_board_by_struct(board, &bscore);
+  return bscore.totalscore[role];
+}
+
+/* prototype in ai.h */
+int ai_init() {
+  /* load weights before building tables */
+  if (weight_file && !ai_load_weights(weight_file, eval_weights))
+    return 0;
+  pattern_prepare();
+  group_prepare();
+  simd_prepare();
+  return 1;
+}
+
 /* register an AI player */
 /* prototype in ai.h */
 int ai_register_player(int role, int aitype) {
+  if (!ai_init() || !pool_init())
+    return 0;
   hashtable_init();
-  return pai_register_player(role, ai_callback, 0, 1);
+  return pai_register_player(role, ai_callback, (void *)(intptr_t)aitype, 1);
 }
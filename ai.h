@@ -30,12 +30,133 @@
 /* polluted */
 #define SCORE_PO 1
 
+/* evaluation weights, defaulting to the scores above */
+/* usage: weights[AI_WEIGHT_*] */
+#define AI_WEIGHT_S1 0 /* SCORE_S1 ~ SCORE_S5 */
+#define AI_WEIGHT_O1 5 /* SCORE_O1 ~ SCORE_O5 */
+#define AI_WEIGHT_VO 10
+#define AI_WEIGHT_PO 11
+#define AI_WEIGHT_NUM 12
+typedef int ai_weights[AI_WEIGHT_NUM];
+
+/*
+ * ai_init: load weights and build scoring tables of the current board size
+ *
+ * The weight file set by ai_weights_file is loaded if any, and
+ * the board size should be set before calling.
+ * Called by ai_register_player, and needed before ai_evaluate
+ * if no AI player is registered.
+ *
+ * Return value:
+ *    nonzero for success, otherwise 0
+ *
+ */
+
+int ai_init();
+
+/*
+ * ai_get_weights: get current evaluation weights
+ *
+ * Parameters:
+ *    weights: array to store the weights
+ *
+ */
+
+void ai_get_weights(ai_weights weights);
+
+/*
+ * ai_set_weights: set evaluation weights and rebuild scoring tables
+ *
+ * Parameters:
+ *    weights: the weights
+ *
+ */
+
+void ai_set_weights(const ai_weights weights);
+
+/*
+ * ai_load_weights: read evaluation weights from a file
+ *
+ * Each line of the file is a name (S1 ~ S5, O1 ~ O5, VO or PO)
+ * followed by its value, and text after # is ignored.
+ * Weights not in the file are left unchanged.
+ *
+ * Parameters:
+ *    path: path of the file
+ *    weights: the weights to update
+ *
+ * Return value:
+ *    nonzero for success, otherwise 0
+ *
+ */
+
+int ai_load_weights(const char *path, ai_weights weights);
+
+/*
+ * ai_save_weights: write evaluation weights in the format of ai_load_weights
+ *
+ * Parameters:
+ *    fp: the file to write
+ *    weights: the weights
+ *
+ */
+
+void ai_save_weights(FILE *fp, const ai_weights weights);
+
+/*
+ * ai_weights_file: set the weight file loaded by ai_init
+ *
+ * Parameters:
+ *    path: path of the file, or NULL for default weights
+ *
+ */
+
+void ai_weights_file(const char *path);
+
+/* max number of search threads (one stats slot each, see stats.h) */
+#define AI_THREADS_MAX 63
+
+/*
+ * ai_threads: set the search threads created by ai_register_player
+ *
+ * Takes effect when the threads are created, so call it before
+ * registering AI players.
+ *
+ * Parameters:
+ *    n: number of threads (at most AI_THREADS_MAX), or 0 for default
+ *    pin: nonzero to pin each thread to a processor
+ *
+ */
+
+void ai_threads(int n, int pin);
+
+/*
+ * ai_evaluate: static evaluation of a board
+ *
+ * The score is a linear function of the evaluation weights.
+ * Thread-safe while the weights are not being set.
+ *
+ * Parameters:
+ *    board: the board
+ *    role: the role to evaluate for
+ *
+ * Return value:
+ *    score of the board for role
+ *
+ */
+
+int ai_evaluate(board_t board, int role);
+
+/* types of AI */
+#define AI_TYPE_SPLIT 0 /* points of the root are split among threads */
+#define AI_TYPE_LAZY_SMP 1 /* threads search all points, sharing the hash table */
+
 /*
  * ai_register_player: register a player as an AI
  *
  * Parameters:
  *    role: the role id
- *    aitype: the type of AI (currently unused)
+ *    aitype: the type of AI (AI_TYPE_*)
  *
  * Return value:
  *    nonzero for success, otherwise 0
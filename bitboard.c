@@ -0,0 +1,34 @@
+/*
+ * bitboard.c: Implementation of bitboard
+ *
+ */
+
+#include "bitboard.h"
+
+/* build bitboard from board_t */
+/* prototype in bitboard.h */
+void bitboard_from_board(bitboard *bb, board_t board) {
+  int i, j;
+  uint32_t saved[BITBOARD_NEAR*2+1];
+  memset(bb, 0, sizeof(bitboard));
+  /* iterate all points */
+  for (i=0; i<BOARD_W; i++)
+    for (j=0; j<BOARD_H; j++)
+      if (board[i][j] != I_FREE)
+        bitboard_place(bb, i, j, board[i][j]-1, saved);
+}
+
+/* check if there is any piece around a point */
+/* prototype in bitboard.h */
+int bitboard_near(bitboard *bb, int x, int y, int dist) {
+  int i;
+  uint32_t mask;
+  /* mask of y-dist ~ y+dist */
+  mask = (2u << 2*dist) - 1;
+  mask = y >= dist ? mask << (y-dist) : mask >> (dist-y);
+  /* test columns x-dist ~ x+dist */
+  for (i=x-dist; i<=x+dist; i++)
+    if (i >= 0 && i < BOARD_W && bitboard_column(bb, i) & mask)
+      return 1;
+  return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * bitboard.h: Definitions of bitboard
+ *
+ * functions in this module are guaranteed to be thread-safe
+ *
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "gomoku.h"
+
+/*
+ * About bitboard
+ * Pieces of each role are kept as bit masks of lines in all 4
+ * directions, so that tests along a line are shifts and masks.
+ * board_t is still maintained alongside as a compatibility view.
+ * Points within BITBOARD_NEAR of any piece are kept as well, so that
+ * moves are generated only around pieces.
+ *
+ * directions (same as linearr in ai.c):
+ *   0: (1,0)   line = y,                bit = x
+ *   1: (0,1)   line = x,                bit = y
+ *   2: (1,1)   line = x-y+BOARD_MAX-1,  bit = x
+ *   3: (1,-1)  line = x+y,              bit = x
+ *
+ */
+
+/* number of lines in a direction */
+#define BITBOARD_LINES (BOARD_MAX*2-1)
+
+/* max distance of candidates from pieces in both coordinates */
+#define BITBOARD_NEAR 2
+
+/* bitboard definition */
+typedef struct {
+  /* subscript = [role][direction][line] */
+  uint32_t line[2][4][BITBOARD_LINES];
+  /* points within BITBOARD_NEAR of any piece in each column (bit = y) */
+  /* occupied points are included, use BB_NEAR to access */
+  uint32_t near[BOARD_MAX+BITBOARD_NEAR*2];
+  /* number of pieces */
+  int npiece;
+} bitboard;
+
+/* line number of a point in direction d */
+#define BB_LINE(d, x, y) ( \
+    (d) == 0 ? (y) : \
+    (d) == 1 ? (x) : \
+    (d) == 2 ? (x)-(y)+BOARD_MAX-1 : \
+    (x)+(y) )
+
+/* bit number of a point in direction d */
+#define BB_BIT(d, x, y) ((d) == 1 ? (y) : (x))
+
+/* mask of points near pieces in column x */
+/* near is padded by BITBOARD_NEAR columns on both sides */
+#define BB_NEAR(bb, x) ((bb)->near[(x)+BITBOARD_NEAR])
+
+/*
+ * bitboard_from_board: build bitboard from board_t
+ *
+ * Parameters:
+ *    bb: the bitboard to be built
+ *    board: the chess board
+ *
+ */
+
+void bitboard_from_board(bitboard *bb, board_t board);
+
+/*
+ * bitboard_near: check if there is any piece around a point
+ *
+ * Parameters:
+ *    bb: the bitboard
+ *    x, y: the point
+ *    dist: max distance in both coordinates
+ *
+ * Return value:
+ *    nonzero if any piece is within dist
+ *
+ */
+
+int bitboard_near(bitboard *bb, int x, int y, int dist);
+
+/* get mask of occupied points in column x (bit = y) */
+static inline uint32_t bitboard_column(bitboard *bb, int x) {
+  return bb->line[0][1][x] | bb->line[1][1][x];
+}
+
+/* place or remove a piece of role (toggle) */
+/* near points are not updated, see bitboard_place and bitboard_remove */
+static inline void bitboard_toggle(bitboard *bb, int x, int y, int role) {
+  bb->line[role][0][BB_LINE(0, x, y)] ^= 1u << BB_BIT(0, x, y);
+  bb->line[role][1][BB_LINE(1, x, y)] ^= 1u << BB_BIT(1, x, y);
+  bb->line[role][2][BB_LINE(2, x, y)] ^= 1u << BB_BIT(2, x, y);
+  bb->line[role][3][BB_LINE(3, x, y)] ^= 1u << BB_BIT(3, x, y);
+}
+
+/* place a piece of role and mark points near it */
+/* saved receives BITBOARD_NEAR*2+1 masks for bitboard_remove */
+static inline void bitboard_place(bitboard *bb, int x, int y, int role, uint32_t *saved) {
+  int i;
+  /* mask of y-BITBOARD_NEAR ~ y+BITBOARD_NEAR */
+  uint32_t mask = ((2u << BITBOARD_NEAR*2) - 1) << y >> BITBOARD_NEAR;
+  bitboard_toggle(bb, x, y, role);
+  bb->npiece++;
+  /* columns x-BITBOARD_NEAR ~ x+BITBOARD_NEAR */
+  for (i=0; i<=BITBOARD_NEAR*2; i++) {
+    saved[i] = bb->near[x+i];
+    bb->near[x+i] |= mask;
+  }
+}
+
+/* remove a piece of role placed by bitboard_place */
+/* pieces must be removed in the reverse order of placement */
+static inline void bitboard_remove(bitboard *bb, int x, int y, int role, uint32_t *saved) {
+  int i;
+  bitboard_toggle(bb, x, y, role);
+  bb->npiece--;
+  for (i=0; i<=BITBOARD_NEAR*2; i++)
+    bb->near[x+i] = saved[i];
+}
+
+/* check if a point is occupied */
+static inline int bitboard_occupied(bitboard *bb, int x, int y) {
+  return bitboard_column(bb, x) >> y & 1;
+}
+
+/* check if the piece of role on a point makes five in a row */
+/* (exactly five for black, at least five for white, same as judge) */
+static inline int bitboard_five(bitboard *bb, int x, int y, int role) {
+  int d, b;
+  uint32_t m, r5, r6;
+  for (d=0; d<4; d++) {
+    m = bb->line[role][d][BB_LINE(d, x, y)];
+    b = BB_BIT(d, x, y);
+    /* bit i of r5 is set if bits i~i+4 are all set */
+    r5 = m & m >> 1;
+    r5 &= r5 >> 2;
+    r5 &= m >> 4;
+    /* keep runs containing b */
+    if (!(r5 & (0x1fu << b) >> 4))
+      continue;
+    /* white wins with overline */
+    if (role)
+      return 1;
+    /* black wins only if no run of 6 contains b */
+    r6 = r5 & m >> 5;
+    if (!(r6 & (0x3fu << b) >> 5))
+      return 1;
+  }
+  return 0;
+}
+
+#endif /* BITBOARD_H */
@@ -103,8 +103,8 @@ static void cli_display(board_t board, pos *newest, char *msg, unsigned long lon
  * A10 a10 10A 10a (3 chars)
  */
 
-/* 0 on failure, non-0 on success  */
-static int cli_parse_coordinate(char *str, pos *p) {
+/* prototype in cli.h */
+int cli_parse_coordinate(const char *str, pos *p) {
   int i, j;
   /* 3 chars */
   if (strlen(str) == 3) {
@@ -29,4 +29,18 @@ int cli_init();
 
 int cli_register_player(int role);
 
+/*
+ * cli_parse_coordinate: parse coordinates in the format of user input
+ *
+ * Parameters:
+ *    str: the coordinates, such as A1 or 10a
+ *    p: position to store
+ *
+ * Return value:
+ *    nonzero for success, otherwise 0
+ *    (the position is not checked against the board size)
+ */
+
+int cli_parse_coordinate(const char *str, pos *p);
+
 #endif /* CLI_H */
@@ -23,9 +23,19 @@
 
 /* Chessboard definitions */
 
+/* max board size */
+#define BOARD_MAX 20
+/* min board size */
+#define BOARD_MIN 5
+/* default board size */
+#define BOARD_DEFAULT 15
+
+/* board size (square), set by pai_set_board_size */
+extern int board_size;
+
 /* board dimensions */
-#define BOARD_W 15
-#define BOARD_H 15
+#define BOARD_W board_size
+#define BOARD_H board_size
 
 /* check if coordinates are valid */
 #define VALID_COORD(x, y) ( \
@@ -33,7 +43,25 @@
     (y) >= 0 && (y) < BOARD_H )
 
 /* board is a 2-dimension array */
-typedef char board_t[BOARD_W][BOARD_H];
+/* only [0, BOARD_W) x [0, BOARD_H) is used, and the rest is free */
+typedef char board_t[BOARD_MAX][BOARD_MAX];
+
+/*
+ * Specialized kernels
+ * Hot functions depending on the board size are written as always
+ * inlined kernels taking the size as the last parameter. Calling them
+ * with BOARD_DISPATCH instantiates them for common sizes, so that the
+ * size is a constant in each instance.
+ *
+ */
+
+#define BOARD_INLINE static inline __attribute__((always_inline))
+
+#define BOARD_DISPATCH(kernel, ...) ( \
+    board_size == 15 ? kernel(__VA_ARGS__, 15) : \
+    board_size == 19 ? kernel(__VA_ARGS__, 19) : \
+    board_size == 20 ? kernel(__VA_ARGS__, 20) : \
+    kernel(__VA_ARGS__, board_size) )
 
 /* Position structure */
 
@@ -4,83 +4,437 @@
  */
 
 #include "hash.h"
+#include "stats.h"
 
 /* Zobrist's hashing method is used here */
-#include "zobrist.h"
+/* zobrist values are generated at startup, see hash_prepare */
 
-/* hash table node definition */
-typedef struct _hash_node {
-  /* next node in this chain */
-  struct _hash_node *next;
-  /* hash value */
-  HASHVALUE hash;
-  /* current move count */
-  int move;
-  /* current depth */
-  int depth;
-  /* node type */
-  hash_type type;
-  /* node value */
-  int value;
-} hash_node;
-
-/* chains in a hash bin (prime is preferred) */
-#define HASHBIN_PRIME 65537
-
-/* hash bin definition */
+/* use mmap for table allocation */
+#include <sys/mman.h>
+/* use open, shm_open & fstat for persistent & shared table */
+#include <fcntl.h>
+#include <sys/stat.h>
+/* use flock to serialize setting up the table between processes */
+#include <sys/file.h>
+/* offsetof */
+#include <stddef.h>
+
+/*
+ * Transposition table
+ *
+ * The table is an array of buckets, each of which fits in a cache line
+ * and holds HASH_BUCKET_ENTRIES entries, so a probe costs a single
+ * cache miss. The table is allocated once with a fixed size and old
+ * entries are replaced by depth and age.
+ *
+ */
+
+/*
+ * Entries are accessed without locks. The key word is stored as the
+ * hash value XORed with the data word, so an entry torn by concurrent
+ * writers fails verification and is treated as a miss.
+ *
+ */
+
+/* hash table entry definition (16 bytes) */
+typedef struct {
+  /* hash value ^ data */
+  uint64_t key;
+  /* packed data, see HASH_DATA_* */
+  uint64_t data;
+} hash_entry;
+
+/* atomic access of entry words */
+#define HASH_LOAD(p) __atomic_load_n(&(p), __ATOMIC_RELAXED)
+#define HASH_STORE(p, v) __atomic_store_n(&(p), (v), __ATOMIC_RELAXED)
+
+/* layout of packed data */
+/*  0~31: node value */
+/* 32~39: current depth (0 for empty entry) */
+/* 40~41: node type */
+/* 42~47: generation of search */
+/* 48~63: best move (x*BOARD_MAX+y in orientation of key, HASH_NOMOVE for none) */
+#define HASH_DATA_VALUE(d) ((int)(int32_t)(uint32_t)(d))
+#define HASH_DATA_DEPTH(d) ((int)((d) >> 32 & 0xff))
+#define HASH_DATA_TYPE(d) ((hash_type)((d) >> 40 & 0x3))
+#define HASH_DATA_GEN(d) ((int)((d) >> 42 & 0x3f))
+#define HASH_DATA_BEST(d) ((int)((d) >> 48 & 0xffff))
+#define HASH_DATA_PACK(value, depth, type, gen, best) ( \
+    (uint64_t)(uint32_t)(value) | \
+    (uint64_t)((depth) & 0xff) << 32 | \
+    (uint64_t)((type) & 0x3) << 40 | \
+    (uint64_t)((gen) & 0x3f) << 42 | \
+    (uint64_t)((best) & 0xffff) << 48 )
+
+/* no best move */
+#define HASH_NOMOVE 0xffff
+
+/* mask of generation counter */
+#define HASH_GEN_MASK 0x3f
+/* replace generation of packed data */
+#define HASH_DATA_SETGEN(d, gen) ( \
+    ((d) & ~((uint64_t)HASH_GEN_MASK << 42)) | (uint64_t)(gen) << 42 )
+
+/* entries in a bucket */
+#define HASH_BUCKET_ENTRIES 4
+
+/* size of explicit huge pages */
+#define HASH_HUGE_PAGE (2<<20)
+
+/* bucket definition (one cache line) */
 typedef struct {
-  /* chains */
-  hash_node *node[HASHBIN_PRIME]; /* subscript = hash % HASHBIN_PRIME */
-  /* mutex for chains */
-  pthread_mutex_t mutex[HASHBIN_PRIME];
-  /* performance counter */
-  int count[HASHBIN_PRIME]; 
-} hash_bin;
-
-/* hash bins */
-static hash_bin m_hashbin[256]; /* subscript = high byte of hash */
+  hash_entry entry[HASH_BUCKET_ENTRIES];
+} __attribute__((aligned(64))) hash_bucket;
+
+/*
+ * Persistent & shared table
+ *
+ * If a file is specified, the table is mapped from it and kept across
+ * games. The file begins with a header describing the table, and its
+ * contents are discarded if the header does not match.
+ *
+ * If a shared memory object is specified instead, the table is mapped
+ * from it and shared by all processes using the same name. Since
+ * entries are lock-free, processes may search concurrently. A shared
+ * table is never discarded; processes with a mismatching table fall
+ * back to private memory.
+ *
+ */
+
+/* magic of table file */
+#define HASH_MAGIC "GMKHASH"
+/* version of table layout, increase on incompatible changes */
+#define HASH_VERSION 4
+
+/* header of table file (one cache line) */
+typedef struct {
+  char magic[8]; /* HASH_MAGIC */
+  uint32_t version; /* HASH_VERSION */
+  uint32_t bucketsize; /* sizeof(hash_bucket) */
+  uint64_t nbucket; /* number of buckets */
+  uint64_t zobrist; /* checksum of zobrist table */
+  uint32_t boardw, boardh; /* board dimensions */
+  uint32_t gen; /* generation of last search */
+} __attribute__((aligned(64))) hash_header;
+
+/* mapped memory (header and buckets) */
+static void *m_map;
+/* header of table file, null if not persistent */
+static hash_header *m_header;
+/* path of table file or name of shared memory object */
+static const char *m_path;
+/* nonzero if m_path is a shared memory object */
+static int m_shared;
+/* bucket array */
+static hash_bucket *m_bucket;
+/* number of buckets (power of 2) */
+static size_t m_nbucket;
+/* size of allocated memory */
+static size_t m_size;
+/* length of mapping, m_size rounded up for huge pages */
+static size_t m_maplen;
+/* generation of current search */
+static int m_gen;
+/* configured size in megabytes */
+static size_t m_mb = HASHTABLE_DEFAULT_MB;
+/* use huge pages */
+static int m_hugepages;
 /* initialized state */
 static int m_init = 0;
 
+/* zobrist values of pieces, subscript = (x*BOARD_MAX+y)*2+piece-1 */
+static uint64_t zobrist[BOARD_MAX*BOARD_MAX*2];
+/* transformed point indexes, subscript = [sym][x*BOARD_MAX+y] */
+static uint16_t m_symindex[HASH_SYMMETRIES][BOARD_MAX*BOARD_MAX];
+/* board size of m_symindex, 0 if zobrist values are not generated */
+static int m_prepared;
+
+/* index of a point transformed by symmetry sym */
+/* bit 0: transpose, bit 1: flip x, bit 2: flip y */
+static inline int sym_index(int sym, int x, int y) {
+  int t;
+  if (sym & 1) {
+    t = x;
+    x = y;
+    y = t;
+  }
+  if (sym & 2) x = BOARD_W-1-x;
+  if (sym & 4) y = BOARD_H-1-y;
+  return x*BOARD_MAX+y;
+}
+
+/* inverse of sym_index */
+static inline void sym_inverse(int sym, int index, pos *p) {
+  int t, x, y;
+  x = index / BOARD_MAX;
+  y = index % BOARD_MAX;
+  if (sym & 4) y = BOARD_H-1-y;
+  if (sym & 2) x = BOARD_W-1-x;
+  if (sym & 1) {
+    t = x;
+    x = y;
+    y = t;
+  }
+  p->x = x;
+  p->y = y;
+}
+
+/* zobrist value of side to move (white) */
+#define ZOBRIST_SIDE 0x9e3779b97f4a7c15ull
+
+/* zobrist value of a piece on point index */
+#define ZOBRIST(index, piece) (zobrist[(index)*2+(piece)-1])
+
+/* generate zobrist values (deterministic) and symmetry tables */
+static void hash_prepare() {
+  int i, j, k;
+  uint64_t seed, z;
+  if (m_prepared == board_size) return;
+  /* splitmix64 with a fixed seed */
+  if (!m_prepared)
+    for (i=0, seed=0x5eed600d0f15ull; i<BOARD_MAX*BOARD_MAX*2; i++) {
+      z = (seed += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      zobrist[i] = z ^ (z >> 31);
+    }
+  /* transformed indexes depend on board size */
+  for (k=0; k<HASH_SYMMETRIES; k++)
+    for (i=0; i<BOARD_W; i++)
+      for (j=0; j<BOARD_H; j++)
+        m_symindex[k][i*BOARD_MAX+j] = sym_index(k, i, j);
+  m_prepared = board_size;
+}
+
+/* get canonical hash value (minimum in all orientations) */
+/* *psym receives the orientation of the canonical value */
+static inline HASHVALUE hash_canonical(hash_state *state, int *psym) {
+  int i, sym = 0;
+  HASHVALUE value = state->value[0];
+  for (i=1; i<HASH_SYMMETRIES; i++)
+    if (state->value[i] < value) {
+      value = state->value[i];
+      sym = i;
+    }
+  *psym = sym;
+  return value;
+}
+
 /* hash by board_t */
 /* prototype in hash.h */
-HASHVALUE hash_board(board_t board) {
-  int i, j, piece;
-  int index;
-  HASHVALUE value = 0;
+void hash_board(board_t board, hash_state *state) {
+  int i, j, k, piece;
+  HASHVALUE side = 0;
+  hash_prepare();
+  memset(state, 0, sizeof(hash_state));
   /* iterate all points */
   for (i=0; i<BOARD_W; i++) 
     for (j=0; j<BOARD_H; j++) {
       piece = board[i][j];
       if (piece) {
-        index = i*BOARD_H+j;
-        value ^= zobrist[index*piece];
+        for (k=0; k<HASH_SYMMETRIES; k++)
+          state->value[k] ^= ZOBRIST(m_symindex[k][i*BOARD_MAX+j], piece);
+        /* each piece flips side to move */
+        side ^= ZOBRIST_SIDE;
       }
     }
-  return value;
+  for (k=0; k<HASH_SYMMETRIES; k++)
+    state->value[k] ^= side;
 }
 
 /* apply delta and hash by board_t */
 /* prototype in hash.h */
-HASHVALUE hash_board_apply_delta(HASHVALUE oldvalue, board_t board, int newx, int newy, int piece, int remove) {
-  int index;
-  index = newx*BOARD_H+newy;
+void hash_board_apply_delta(hash_state *state, board_t board, int newx, int newy, int piece, int remove) {
   board[newx][newy] = remove ? I_FREE : piece;
-  return oldvalue ^ zobrist[index*piece];
+  hash_apply_delta(state, newx, newy, piece);
+}
+
+/* apply delta to hash state only */
+/* prototype in hash.h */
+void hash_apply_delta(hash_state *state, int newx, int newy, int piece) {
+  int k, index;
+  index = newx*BOARD_MAX+newy;
+  /* side to move is flipped as well */
+  for (k=0; k<HASH_SYMMETRIES; k++)
+    state->value[k] ^= ZOBRIST(m_symindex[k][index], piece) ^ ZOBRIST_SIDE;
+}
+
+/* set up size of hash table */
+/* prototype in hash.h */
+void hashtable_config(size_t mb, int hugepages) {
+  /* at least one megabyte */
+  m_mb = mb ? mb : 1;
+  m_hugepages = hugepages;
+  /* reallocate if already initialized */
+  if (m_init) {
+    hashtable_fini();
+    hashtable_init();
+  }
+}
+
+/* set up table file */
+/* prototype in hash.h */
+void hashtable_persist(const char *path) {
+  m_path = path;
+  m_shared = 0;
+  /* reopen if already initialized */
+  if (m_init) {
+    hashtable_fini();
+    hashtable_init();
+  }
+}
+
+/* set up shared memory object */
+/* prototype in hash.h */
+void hashtable_share(const char *name) {
+  m_path = name;
+  m_shared = 1;
+  /* reopen if already initialized */
+  if (m_init) {
+    hashtable_fini();
+    hashtable_init();
+  }
+}
+
+/* checksum of zobrist table */
+static uint64_t zobrist_checksum() {
+  size_t i;
+  uint64_t sum = 0;
+  for (i=0; i<sizeof(zobrist)/sizeof(zobrist[0]); i++)
+    sum = (sum << 7 | sum >> 57) ^ zobrist[i];
+  return sum;
+}
+
+/* fill header of table file */
+static void fill_header(hash_header *header) {
+  memset(header, 0, sizeof(hash_header));
+  memcpy(header->magic, HASH_MAGIC, sizeof(HASH_MAGIC));
+  header->version = HASH_VERSION;
+  header->bucketsize = sizeof(hash_bucket);
+  header->nbucket = m_nbucket;
+  header->zobrist = zobrist_checksum();
+  header->boardw = BOARD_W;
+  header->boardh = BOARD_H;
+}
+
+/* map table file or shared memory object, return MAP_FAILED on error */
+/* contents are kept only if the header matches */
+/* the file is locked until the header is written, so a process opening */
+/* it meanwhile waits instead of finding a partial header */
+static void* map_file(const char *path, int shared) {
+  int fd, valid, empty;
+  struct stat st;
+  hash_header header, expected;
+  static const hash_header zero;
+  void *p;
+  /* open or create file */
+  fd = shared ?
+    shm_open(path, O_RDWR|O_CREAT, 0644) :
+    open(path, O_RDWR|O_CREAT, 0644);
+  if (fd < 0) {
+    perror(path);
+    return MAP_FAILED;
+  }
+  if (flock(fd, LOCK_EX)) {
+    perror(path);
+    close(fd);
+    return MAP_FAILED;
+  }
+  /* check size and header */
+  fill_header(&expected);
+  if (fstat(fd, &st)) {
+    perror(path);
+    close(fd);
+    return MAP_FAILED;
+  }
+  valid = (size_t)st.st_size == m_size &&
+    pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+    !memcmp(&header, &expected, offsetof(hash_header, gen));
+  if (shared && !valid) {
+    /* new object, or left by a process failing to set it up */
+    empty = !st.st_size || ((size_t)st.st_size == m_size &&
+        pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+        !memcmp(&header, &zero, sizeof(header)));
+    if (!empty || ftruncate(fd, m_size)) {
+      fprintf(stderr, "hash: shared table %s does not match\n", path);
+      close(fd);
+      return MAP_FAILED;
+    }
+  }
+  /* discard contents otherwise */
+  else if (!valid && (ftruncate(fd, 0) || ftruncate(fd, m_size))) {
+    perror(path);
+    close(fd);
+    return MAP_FAILED;
+  }
+  p = mmap(0, m_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED) {
+    perror(path);
+    close(fd);
+    return p;
+  }
+  /* write new header */
+  if (!valid)
+    memcpy(p, &expected, sizeof(hash_header));
+  /* closing releases the lock */
+  close(fd);
+  return p;
 }
 
 /* initialize hash table */
 /* prototype in hash.h */
 void hashtable_init() {
-  int i, j;
+  void *p = MAP_FAILED;
   /* if not initialized */
   if (!m_init) {
-    /* clear structures */
-    memset(m_hashbin, 0, sizeof(m_hashbin));
-    /* initialize mutexes */
-    for (i=0; i<256; i++)
-      for (j=0; j<HASHBIN_PRIME; j++)
-        pthread_mutex_init(&m_hashbin[i].mutex[j], 0);
+    /* zobrist values are checked in header */
+    hash_prepare();
+    /* round down to power of 2 */
+    m_nbucket = 1;
+    while (m_nbucket*2*sizeof(hash_bucket) <= m_mb<<20)
+      m_nbucket *= 2;
+    m_size = m_nbucket*sizeof(hash_bucket);
+    m_maplen = m_size;
+    m_header = 0;
+    m_gen = 0;
+    /* persistent or shared table */
+    if (m_path) {
+      m_size += sizeof(hash_header);
+      p = map_file(m_path, m_shared);
+      if (p != MAP_FAILED) {
+        m_header = p;
+        m_gen = m_header->gen & HASH_GEN_MASK;
+      }
+      else
+        m_size -= sizeof(hash_header);
+      m_maplen = m_size;
+    }
+#ifdef MAP_HUGETLB
+    /* try explicit huge pages first, mapped in whole pages */
+    if (p == MAP_FAILED && m_hugepages) {
+      m_maplen = (m_size+HASH_HUGE_PAGE-1) & ~(size_t)(HASH_HUGE_PAGE-1);
+      p = mmap(0, m_maplen, PROT_READ|PROT_WRITE,
+          MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+      if (p == MAP_FAILED)
+        m_maplen = m_size;
+    }
+#endif
+    /* zero-filled pages are mapped on demand */
+    if (p == MAP_FAILED) {
+      p = mmap(0, m_size, PROT_READ|PROT_WRITE,
+          MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+      /* fall back to transparent huge pages */
+      if (p != MAP_FAILED && m_hugepages)
+        madvise(p, m_size, MADV_HUGEPAGE);
+#endif
+    }
+    if (p == MAP_FAILED) {
+      fprintf(stderr, "hash: unable to allocate %zu bytes\n", m_size);
+      return;
+    }
+    m_map = p;
+    m_bucket = (hash_bucket*)((char*)p + (m_header ? sizeof(hash_header) : 0));
     m_init = 1;
   }
 }
@@ -88,100 +442,158 @@ void hashtable_init() {
 /* finalize hash table */
 /* prototype in hash.h */
 void hashtable_fini() {
-  int i, j;
-  hash_node *node, *next;
   /* return if finalized */
   if (!m_init) return;
-  /* iterate all chains in all bins */
-  for (i=0; i<256; i++)
-    for (j=0; j<HASHBIN_PRIME; j++) {
-      /* get root node */
-      node = m_hashbin[i].node[j];
-#if 0
-      /* test only */
-      fprintf(stderr, "bin[%d][%d]: %d\n", i, j, m_hashbin[i].count[j]);
-#endif
-      /* free all nodes */
-      while (node) {
-        next = node->next;
-        free(node);
-        node = next;
-      }
-      /* destroy mutexes */
-      pthread_mutex_destroy(&m_hashbin[i].mutex[j]);
-    }
+  /* write back persistent or shared table */
+  if (m_header)
+    msync(m_map, m_size, MS_ASYNC);
+  /* release memory */
+  munmap(m_map, m_maplen);
+  m_map = 0;
+  m_header = 0;
+  m_bucket = 0;
   /* clear state */
   m_init = 0;
 }
 
+/* start a new search */
+/* prototype in hash.h */
+void hashtable_new_search() {
+  /* generation is saved for the next game, or shared by processes */
+  if (m_header)
+    m_gen = __atomic_add_fetch(&m_header->gen, 1, __ATOMIC_RELAXED) & HASH_GEN_MASK;
+  else
+    m_gen = (m_gen+1) & HASH_GEN_MASK;
+}
+
 /* store value to hash table */
 /* prototype in hash.h */
-/* thread-safe */
-void hashtable_store(HASHVALUE hash, int move, int depth, hash_type type, int value) {
-  int i, j;
-  hash_node *node;
-  /* calculate bin and chain number */
-  i = hash >> (sizeof(HASHVALUE)-1)*8;
-  j = hash % HASHBIN_PRIME;
-  /* lock chain */
-  pthread_mutex_lock(&m_hashbin[i].mutex[j]);
-  /* allocate node */
-  node = malloc(sizeof(hash_node));
-  /* exit on error in malloc */
-  if (!node) return;
+/* thread-safe (lock-free) */
+void hashtable_store(hash_state *state, int depth, hash_type type, int value, pos *best) {
+  HASHVALUE hash;
+  size_t i;
+  int j, sym, gen, age, prio, minprio, bestidx;
+  uint64_t data;
+  hash_bucket *bucket;
+  hash_entry *entry, *victim;
+  /* exit if not allocated */
+  if (!m_init) return;
+  /* calculate bucket number */
+  hash = hash_canonical(state, &sym);
+  i = hash & (m_nbucket-1);
+  bucket = &m_bucket[i];
+  gen = m_gen;
+  bestidx = best && best->x >= 0 ? m_symindex[sym][best->x*BOARD_MAX+best->y] : HASH_NOMOVE;
+  STAT_INC(stat_store);
+  victim = 0;
+  minprio = 0;
+  for (j=0; j<HASH_BUCKET_ENTRIES; j++) {
+    entry = &bucket->entry[j];
+    data = HASH_LOAD(entry->data);
+    /* same node, replace unless deeper result of current search exists */
+    if ((HASH_LOAD(entry->key) ^ data) == hash && HASH_DATA_DEPTH(data)) {
+      if (type != hash_exact && HASH_DATA_GEN(data) == gen &&
+          HASH_DATA_DEPTH(data) > depth)
+        return;
+      /* keep previous best move if no new one */
+      if (bestidx == HASH_NOMOVE)
+        bestidx = HASH_DATA_BEST(data);
+      victim = entry;
+      minprio = -1;
+      break;
+    }
+    /* empty entries are replaced first, then shallow and old ones */
+    if (!HASH_DATA_DEPTH(data))
+      prio = -1;
+    else {
+      age = (gen - HASH_DATA_GEN(data)) & HASH_GEN_MASK;
+      prio = HASH_DATA_DEPTH(data) - 8*age + 8*(HASH_GEN_MASK+1);
+    }
+    if (!victim || prio < minprio) {
+      victim = entry;
+      minprio = prio;
+    }
+  }
+  /* another position is replaced */
+  if (minprio >= 0)
+    STAT_INC(stat_overwrite);
   /* fill stuffs */
-  node->hash = hash;
-  node->move = move;
-  node->depth = depth;
-  node->type = type;
-  node->value = value;
-  /* insert as root node */
-  node->next = m_hashbin[i].node[j];
-  m_hashbin[i].node[j] = node;
-  /* update counter */
-  m_hashbin[i].count[j]++;
-  /* unlock chain */
-  pthread_mutex_unlock(&m_hashbin[i].mutex[j]);
+  data = HASH_DATA_PACK(value, depth, type, gen, bestidx);
+  HASH_STORE(victim->data, data);
+  HASH_STORE(victim->key, hash ^ data);
 }
 
 /* look up value in hash table */
 /* prototype in hash.h */
-/* thread-safe */
-int hashtable_lookup(HASHVALUE hash, int move, int depth, int alpha, int beta, int *pvalue) {
-  int i, j;
+/* thread-safe (lock-free) */
+int hashtable_lookup(hash_state *state, int depth, int alpha, int beta, int *pvalue, pos *best) {
+  HASHVALUE hash;
+  size_t i;
+  int j, sym, value, bestidx;
   int result;
-  hash_node *node;
-  /* calculate bin and chain number */
-  i = hash >> (sizeof(HASHVALUE)-1)*8;
-  j = hash % HASHBIN_PRIME;
-  /* lock chain */
-  pthread_mutex_lock(&m_hashbin[i].mutex[j]);
-  /* is empty chain */
-  if (!(node = m_hashbin[i].node[j])) {
-    result = 0;
-    goto _exit;
-  }
-  /* linear search */
-  while (node) {
-    if (node->hash == hash &&
-        node->move == move &&
-        node->depth >= depth) {
+  uint64_t data;
+  hash_bucket *bucket;
+  /* no best move by default */
+  if (best) best->x = best->y = -1;
+  /* exit if not allocated */
+  if (!m_init) return 0;
+  /* calculate bucket number */
+  hash = hash_canonical(state, &sym);
+  i = hash & (m_nbucket-1);
+  bucket = &m_bucket[i];
+  result = 0;
+  STAT_INC(stat_probe);
+  /* search in bucket */
+  for (j=0; j<HASH_BUCKET_ENTRIES; j++) {
+    data = HASH_LOAD(bucket->entry[j].data);
+    if ((HASH_LOAD(bucket->entry[j].key) ^ data) == hash &&
+        HASH_DATA_DEPTH(data)) {
+      STAT_ADD(stat_probe_depth, j+1);
+      /* refresh generation so that the entry survives replacement */
+      if (HASH_DATA_GEN(data) != m_gen) {
+        data = HASH_DATA_SETGEN(data, m_gen);
+        HASH_STORE(bucket->entry[j].data, data);
+        HASH_STORE(bucket->entry[j].key, hash ^ data);
+      }
+      /* report best move even if the value is not usable */
+      bestidx = HASH_DATA_BEST(data);
+      if (best && bestidx != HASH_NOMOVE)
+        sym_inverse(sym, bestidx, best);
+      if (HASH_DATA_DEPTH(data) < depth)
+        return 0;
+      value = HASH_DATA_VALUE(data);
       /* limit result by parameters */
-      if (node->type == hash_exact ||
-          (node->type == hash_alpha && node->value <= alpha) ||
-          (node->type == hash_beta && node->value >= beta)) {
+      if (HASH_DATA_TYPE(data) == hash_exact ||
+          (HASH_DATA_TYPE(data) == hash_alpha && value <= alpha) ||
+          (HASH_DATA_TYPE(data) == hash_beta && value >= beta)) {
         /* found */
-        *pvalue = node->value;
+        *pvalue = value;
         result = 1;
-        goto _exit;
+        STAT_INC(stat_hit);
+        STAT_INC(stat_hit_exact + HASH_DATA_TYPE(data));
       }
+      return result;
     }
-    node = node->next;
   }
   /* not found */
-  result = 0;
-_exit:
-  /* unlock chain */
-  pthread_mutex_unlock(&m_hashbin[i].mutex[j]);
+  STAT_ADD(stat_probe_depth, HASH_BUCKET_ENTRIES);
   return result;
 }
+
+/* get usage of hash table */
+/* prototype in hash.h */
+int hashtable_usage() {
+  int i, j, n, used;
+  uint64_t data;
+  if (!m_init) return 0;
+  /* sample first buckets */
+  n = m_nbucket < 1000 ? m_nbucket : 1000;
+  used = 0;
+  for (i=0; i<n; i++)
+    for (j=0; j<HASH_BUCKET_ENTRIES; j++) {
+      data = HASH_LOAD(m_bucket[i].entry[j].data);
+      if (HASH_DATA_DEPTH(data) && HASH_DATA_GEN(data) == m_gen)
+        used++;
+    }
+  return used * 1000 / (n * HASH_BUCKET_ENTRIES);
+}
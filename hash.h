@@ -11,12 +11,38 @@
 /* hash value type (64-bit integer) */
 typedef uint64_t HASHVALUE;
 
+/*
+ * Hash values depend only on the position and side to move, so results
+ * are shared across move orders and kept between turns.
+ *
+ */
+
+/*
+ * Symmetric hashing
+ *
+ * The board is hashed in all 8 orientations of the dihedral group, and
+ * the minimum value is used as the key so that symmetric positions
+ * share entries in the hash table. Best moves are stored in the
+ * orientation of the key and mapped back on lookup.
+ *
+ */
+
+/* number of board symmetries */
+#define HASH_SYMMETRIES 8
+
+/* hash values of a board in all orientations */
+typedef struct {
+  HASHVALUE value[HASH_SYMMETRIES];
+} hash_state;
+
 /* hashing functions */
 
-/* calculate hash value by board_t */
-HASHVALUE hash_board(board_t);
-/* apply difference and calculate hash value by board_t */
-HASHVALUE hash_board_apply_delta(HASHVALUE, board_t, int, int, int, int);
+/* calculate hash state by board_t */
+void hash_board(board_t, hash_state*);
+/* apply difference to hash state and board_t */
+void hash_board_apply_delta(hash_state*, board_t, int, int, int, int);
+/* apply difference to hash state only (place and remove are the same) */
+void hash_apply_delta(hash_state*, int, int, int);
 
 /* hash table node types */
 typedef enum {
@@ -25,15 +51,58 @@ typedef enum {
   hash_beta
 } hash_type;
 
+/* default size of hash table (in megabytes) */
+#define HASHTABLE_DEFAULT_MB 128
+
 /* hash table functions */
 
+/*
+ * hashtable_config: set up size and backing of hash table
+ *
+ * Parameters:
+ *    mb: size of hash table in megabytes (rounded down to power of 2)
+ *    hugepages: nonzero to back the table with huge pages if possible
+ *
+ * The table is reallocated if it is already initialized.
+ *
+ */
+void hashtable_config(size_t mb, int hugepages);
+/*
+ * hashtable_persist: keep hash table in a file across games
+ *
+ * Parameters:
+ *    path: the file to be memory-mapped, or null for private memory
+ *
+ * The file is created if not existing. Its contents are reused only if
+ * the table size and zobrist table match. The table is reopened if it
+ * is already initialized.
+ *
+ */
+void hashtable_persist(const char *path);
+/*
+ * hashtable_share: share hash table between processes
+ *
+ * Parameters:
+ *    name: name of POSIX shared memory object (e.g. "/gomoku")
+ *
+ * All processes using the same name and table size search on a single
+ * table concurrently. The table is reopened if it is already
+ * initialized.
+ *
+ */
+void hashtable_share(const char *name);
 /* initialize hash table */
 void hashtable_init();
 /* finalize hash table */
 void hashtable_fini();
-/* store value to hash table (thread-safe) */
-void hashtable_store(HASHVALUE, int, int, hash_type, int);
-/* look up hash table (thread-safe) */
-int hashtable_lookup(HASHVALUE, int, int, int, int, int*);
+/* start a new search (entries of older searches are aged) */
+void hashtable_new_search();
+/* store value and best move (may be null) to hash table (thread-safe, lock-free) */
+void hashtable_store(hash_state*, int, hash_type, int, pos*);
+/* look up hash table (thread-safe, lock-free) */
+/* best move (x = -1 if unknown) is returned even if the value is not usable */
+int hashtable_lookup(hash_state*, int, int, int, int*, pos*);
+/* get per mille of entries used by current search (sampled) */
+int hashtable_usage();
 
 #endif /* HASH_H */
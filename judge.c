@@ -17,14 +17,105 @@
  *
  */
 
-/* usage: dirarr[line][direction][0 for x, 1 for y] */
-static const int dirarr[][2][2] = {
-  1,0,-1,0,
-  0,1,0,-1,
-  1,1,-1,-1,
-  1,-1,-1,1
+/* index steps of the lines on padded board */
+/* usage: steparr[line] */
+static const int steparr[] = {
+  PADBOARD_STEP(0),
+  PADBOARD_STEP(1),
+  PADBOARD_STEP(2),
+  PADBOARD_STEP(3)
 };
 
+/* borders are sentinels on padded board, so no bounds are checked */
+
+/* count pieces in a row through a point in a line */
+static inline int count_line(padboard_t board, int newidx, int line) {
+  int i, n, step;
+  int p;
+  char piece = board[newidx];
+  n = 1;
+  /* iterate 2 directions */
+  for (i=0, step=steparr[line]; i<2; i++, step=-step)
+    /* iterate each position until the border */
+    for (p=newidx+step; ; p+=step)
+      if (board[p] == piece)
+        n++;
+      else
+        break;
+  return n;
+}
+
+/* judge if any player has won on padded board */
+/* prototype in judge.h */
+int judge_pad(padboard_t board, int newidx) {
+  int i;
+  /* iterate 4 lines  */
+  for (i=0; i<4; i++)
+    if ((board[newidx] == I_BLACK &&
+        count_line(board, newidx, i) == 5) ||
+        (board[newidx] == I_WHITE &&
+        count_line(board, newidx, i) >= 5))
+      return board[newidx] - 1;
+  return -1;
+}
+
+/*
+ * Judgement on board_t
+ * Pieces within distance 5 in each line are gathered as bits without
+ * building a padded board, with bit 5 for the new piece, and the run
+ * through it is measured by counting ones on both sides. Distance 5 is
+ * enough to tell five from overline.
+ *
+ */
+
+/* index steps of the lines on board_t, and x & y steps for bounds */
+/* usage: boardsteparr[line][0 for index, 1 for x, 2 for y] */
+static const int boardsteparr[][3] = {
+  {BOARD_MAX, 1, 0},
+  {1, 0, 1},
+  {BOARD_MAX+1, 1, 1},
+  {BOARD_MAX-1, 1, -1}
+};
+
+/* range of k where c+step*k is in [0, size), clipped to [-5, 5] */
+static inline void line_range(int c, int step, int size, int *kmin, int *kmax) {
+  int lo, hi;
+  lo = step > 0 ? -c : step < 0 ? c-size+1 : -5;
+  hi = step > 0 ? size-1-c : step < 0 ? c : 5;
+  *kmin = lo > *kmin ? lo : *kmin;
+  *kmax = hi < *kmax ? hi : *kmax;
+}
+
+/* length of the run of ones through bit 5 */
+static inline int run_length(uint32_t m) {
+  /* bits 5~10 upward, and bits 4~0 downward (moved to bits 31~27) */
+  return __builtin_ctz(~(m >> 5)) + __builtin_clz(~(m << 27));
+}
+
+/* judge if any player has won */
+/* prototype in judge.h */
+int judge(board_t board, pos *newpos) {
+  const char *p = &board[newpos->x][newpos->y];
+  char piece = *p;
+  int i, k, kmin, kmax, n, five;
+  uint32_t m;
+  five = 0;
+  for (i=0; i<4; i++) {
+    /* gather pieces on board */
+    kmin = -5;
+    kmax = 5;
+    line_range(newpos->x, boardsteparr[i][1], BOARD_W, &kmin, &kmax);
+    line_range(newpos->y, boardsteparr[i][2], BOARD_H, &kmin, &kmax);
+    m = 0;
+    for (k=kmin; k<=kmax; k++)
+      m |= (uint32_t)(p[boardsteparr[i][0]*k] == piece) << (k+5);
+    /* exactly 5 for black, at least 5 for white */
+    n = run_length(m);
+    five |= (n == 5) | ((piece == I_WHITE) & (n > 5));
+  }
+  return five & ((piece == I_BLACK) | (piece == I_WHITE)) ? piece-1 : -1;
+}
+
 /*
  * patterns:
  *   *  = piece(black)
@@ -43,22 +134,6 @@ static const int dirarr[][2][2] = {
  *
  */
 
-#define PAT_IS_PIECE(board, x, y) ( \
-    (x) >= 0 && (x) < BOARD_W && \
-    (y) >= 0 && (y) < BOARD_H && \
-    board[x][y] == I_BLACK)
-
-#define PAT_IS_FREE(board, x, y) ( \
-    (x) >= 0 && (x) < BOARD_W && \
-    (y) >= 0 && (y) < BOARD_H && \
-    board[x][y] == I_FREE)
-
-/* if free, checkban later */
-#define PAT_IS_BARRIER(board, x, y) ( \
-    (x) < 0 || (x) >= BOARD_W || \
-    (y) < 0 || (x) >= BOARD_H || \
-    board[x][y] != I_BLACK)
-
 /* patterns for open 4 */
 static const char *patopen4[] = {
   "-#****#-"
@@ -75,218 +150,425 @@ static const char *patopen3[] = {
   "+***#+", "+#***+", "+**#*+", "+*#**+"
 };
 
-/* match a specified position on the board with a char pattern (for black only) */
+/*
+ * About ban table
+ * The line through the point in each direction is encoded as a base-3
+ * key of the 10 points within distance 5 (free, black, or others), and
+ * ban_table gives the five/overline status of the line and the matches
+ * of the patterns above, which are found once by ban_prepare.
+ * A match may still depend on whether its free points are banned.
+ * They are checked recursively only if the matches could make 3-3 or
+ * 4-4, with the tentative pieces kept in a list instead of being placed
+ * on the board. Each tentative piece is placed on a point which is free
+ * with the previous ones, so the recursion ends after at most one piece
+ * on each point of the board.
+ *
+ */
+
+/* number of line keys (3^10) */
+#define BAN_KEYS 59049
+
+/* max number of matches in a line (2 open 3 and 3 4 at most) */
+#define BAN_LINE_MAX 8
+
+/* max number of tentative pieces of a ban check, one on each point */
+#define BAN_DEPTH (BOARD_MAX*BOARD_MAX)
+
+/* points of a line key, from -5 to 5 except 0 */
+#define BAN_CODE_FREE 0
+#define BAN_CODE_BLACK 1
+#define BAN_CODE_OTHER 2
+
+/* code of each piece (I_FREE, I_BLACK, I_WHITE or I_BORDER) */
+static const int ban_code[4] = {
+  BAN_CODE_FREE, BAN_CODE_BLACK, BAN_CODE_OTHER, BAN_CODE_OTHER
+};
+
+/* pattern groups of matches, in the order of patopen3, patopen4, patdash4 */
+#define BAN_GROUP_OPEN3 0
+#define BAN_GROUP_FOUR 4
+#define BAN_GROUP_NUM 10
+
+/* a match of a pattern, points as offsets from the checked point */
+typedef struct {
+  signed char group; /* BAN_GROUP_* plus index of the pattern */
+  signed char free[2]; /* # points which should not be banned, 0 if none */
+  signed char barrier; /* free x point which should be banned, 0 if none */
+  signed char four[2]; /* open 3: free points at the ends of the open 4 */
+  signed char edge[2]; /* open 3: points beyond four which should be non piece */
+} ban_match;
+
+/* line status, packed as */
+/* bits 0~1: BAN_LINE_FIVE or BAN_LINE_OVERLINE */
+/* bits 2~4: number of open 3 matches */
+/* bits 5~7: number of 4 matches */
+/* bits 8~31: index of the first match in ban_matches */
+#define BAN_LINE_FIVE 1
+#define BAN_LINE_OVERLINE 2
+#define BAN_LINE_STATUS(l) ((l) & 3)
+#define BAN_LINE_NTHREE(l) ((l) >> 2 & 7)
+#define BAN_LINE_NFOUR(l) ((l) >> 5 & 7)
+#define BAN_LINE_START(l) ((l) >> 8)
+
+/* status of each line key, built by ban_prepare */
+static uint32_t ban_table[BAN_KEYS];
+/* matches of all line keys, built by ban_prepare */
+static ban_match *ban_matches;
+/* ban_prepare is called once */
+static pthread_once_t ban_once = PTHREAD_ONCE_INIT;
+
+/* tentative black pieces of a ban check, the last one being checked */
+typedef struct {
+  int n;
+  int idx[BAN_DEPTH];
+} ban_stones;
+
+/* match a point of a line with a char pattern (for black only) */
 /* return value is nonzero if matched */
-static inline int char_match(board_t board, int x, int y, char pattern) {
+static inline int char_match(int code, char pattern) {
   switch (pattern) {
     case '*':
-      if (PAT_IS_PIECE(board, x, y))
-        return 1;
-      return 0;
+      return code == BAN_CODE_BLACK;
     case '+':
     case '#':
-      if (PAT_IS_FREE(board, x, y))
-        return 1;
-      return 0;
+      return code == BAN_CODE_FREE;
     case 'x':
     case '-':
-      if (PAT_IS_BARRIER(board, x, y))
-        return 1;
-      return 0;
+      /* if free, checkban later */
+      return code != BAN_CODE_BLACK;
   }
   return 0;
 }
 
-/* match a line with a pattern (for black only) */
-/* initial start should be -5 */
-/* if matched, return value is nonzero and *result saves the matched position */
-/* to continue the match, set start to previuos *result */
-static inline int pat_match(board_t board, pos *newpos, int line, const char *pat, int start, int *result) {
-  int i, j;
+/* find matches of a pattern in a line */
+/* line: codes of points from -5 to 5, at line[5+offset] */
+/* group: group of the pattern */
+/* matches: array to store matches */
+/* return value is the number of matches */
+static int pat_match(const int *line, const char *pat, int group, ban_match *matches) {
+  int i, j, n, nfree;
   int l = strlen(pat);
-  pos p;
-  /* iterate each start index of the pattern */
-  for (i=start; i+l-1<=5; i++, j++)
+  ban_match m;
+  n = 0;
+  /* iterate each start offset of the pattern */
+  for (i=-5; i+l-1<=5; i++) {
     /* match each char in the pattern */
-    for (j=0;
-        char_match(board,
-          newpos->x+dirarr[line][0][0]*(i+j),
-          newpos->y+dirarr[line][0][1]*(i+j),
-          pat[j]);
-        j++
-        )
-      /* j>=l-1, each char is matched */
-      if (j>=l-1) {
-        /* scan '#' or 'x' */
-        for (j=0; j<l; j++) {
-          p.x = newpos->x+dirarr[line][0][0]*(i+j);
-          p.y = newpos->y+dirarr[line][0][1]*(i+j);
-          switch (pat[j]) {
-            case '#':
-              /* # should not be banned */
-              if (checkban(board, &p))
-                return 0;
-              break;
-            case 'x':
-              /* x should be barrier or banned */
-              if (p.x>=0 && p.x<BOARD_W &&
-                  p.y>=0 && p.y<BOARD_H &&
-                  board[p.x][p.y] != I_WHITE &&
-                  !checkban(board, &p))
-                return 0;
-              break;
-          }
-        }
-        if (result) *result = i;
-        return 1;
-      }
-  return 0;
+    for (j=0; j<l && char_match(line[5+i+j], pat[j]); j++);
+    if (j < l)
+      continue;
+    /* record points to be checked */
+    memset(&m, 0, sizeof(m));
+    m.group = group;
+    for (j=0, nfree=0; j<l; j++)
+      if (pat[j] == '#')
+        m.free[nfree++] = i+j;
+      else if (pat[j] == 'x' && line[5+i+j] == BAN_CODE_FREE)
+        m.barrier = i+j;
+    /* open 3 becomes -#****#- if placed on # */
+    if (group < BAN_GROUP_FOUR) {
+      m.four[0] = i;
+      m.four[1] = i+5;
+      m.edge[0] = i-1;
+      m.edge[1] = i+6;
+    }
+    matches[n++] = m;
+  }
+  return n;
 }
 
-/* count pieces in a line */
-/* if allowspace, space is ignored when counting */
-static inline int count_line(board_t board, pos *newpos, int line, int allowspace) {
-  int i, n;
-  int x, y;
-  n = 1;
-  /* iterate 2 directions */
-  for (i=0; i<2; i++)
-    /* iterate each position */
-    for (
-        x = newpos->x+dirarr[line][i][0],
-        y = newpos->y+dirarr[line][i][1];
-        VALID_COORD(x, y);
-        x += dirarr[line][i][0],
-        y += dirarr[line][i][1]
-        )
-      if (board[x][y] == board[newpos->x][newpos->y])
-        n++;
-      else if (allowspace && board[x][y] == I_FREE)
-        continue;
-      else
-        break;
+/* find matches of all patterns in a line */
+/* groups in [group0, group1), see pat_match for other parameters */
+static int line_match(const int *line, int group0, int group1, ban_match *matches) {
+  int g, n;
+  n = 0;
+  for (g=group0; g<group1; g++)
+    if (g < BAN_GROUP_FOUR)
+      n += pat_match(line, patopen3[g-BAN_GROUP_OPEN3], g, matches+n);
+    else if (g == BAN_GROUP_FOUR)
+      n += pat_match(line, patopen4[0], g, matches+n);
+    else
+      n += pat_match(line, patdash4[g-BAN_GROUP_FOUR-1], g, matches+n);
   return n;
 }
 
-/* count open 4 in a line (for black only) */
-static inline int count_open_4(board_t board, pos *newpos, int line) {
-  int i, start, count;
-  count = 0;
-  /* match each pattern */
-  for (i=0; i<sizeof(patopen4)/sizeof(char*); i++) {
-    start = -6;
-    /* match until not matched */
-    while (pat_match(board, newpos, line, patopen4[i], start+1, &start))
-      count++;
+/* decode a line key */
+/* line: codes of points from -5 to 5, at line[5+offset] */
+static void ban_decode(int key, int *line) {
+  int i;
+  line[5] = BAN_CODE_BLACK;
+  for (i=-5; i<=5; i++)
+    if (i) {
+      line[5+i] = key % 3;
+      key /= 3;
+    }
+}
+
+/* build ban_table and ban_matches */
+static void ban_prepare() {
+  int line[11];
+  ban_match matches[BAN_LINE_MAX];
+  int key, i, run, nthree, nfour, total, size;
+  total = 0;
+  size = 0;
+  for (key=0; key<BAN_KEYS; key++) {
+    ban_decode(key, line);
+    /* count pieces in a row */
+    run = 1;
+    for (i=1; i<=5 && line[5+i] == BAN_CODE_BLACK; i++, run++);
+    for (i=1; i<=5 && line[5-i] == BAN_CODE_BLACK; i++, run++);
+    /* five or overline decides the ban, patterns are not needed */
+    if (run >= 5) {
+      ban_table[key] = run == 5 ? BAN_LINE_FIVE : BAN_LINE_OVERLINE;
+      continue;
+    }
+    nthree = line_match(line, 0, BAN_GROUP_FOUR, matches);
+    nfour = line_match(line, BAN_GROUP_FOUR, BAN_GROUP_NUM, matches+nthree);
+    ban_table[key] = (uint32_t)total << 8 | nfour << 5 | nthree << 2;
+    /* append matches */
+    if (total+nthree+nfour > size) {
+      size = size ? size*2 : 4096;
+      ban_matches = realloc(ban_matches, size*sizeof(ban_match));
+    }
+    memcpy(ban_matches+total, matches, (nthree+nfour)*sizeof(ban_match));
+    total += nthree+nfour;
   }
-  return count;
 }
 
-/* count dash 4 in a line (for black only) */
-static inline int count_dash_4(board_t board, pos *newpos, int line) {
-  int i, start, count;
-  count = 0;
-  /* match each pattern */
-  for (i=0; i<sizeof(patdash4)/sizeof(char*); i++) {
-    start = -6;
-    /* match until not matched */
-    while (pat_match(board, newpos, line, patdash4[i], start+1, &start))
-      count++;
+/* piece on a point with tentative pieces */
+static inline int ban_piece(padboard_t board, const ban_stones *st, int p) {
+  int i;
+  for (i=0; i<st->n; i++)
+    if (st->idx[i] == p)
+      return I_BLACK;
+  return board[p];
+}
+
+/* line key of a point */
+static inline int ban_key(padboard_t board, const ban_stones *st, int newidx, int step) {
+  int i, key;
+  key = 0;
+  /* only the checked point is placed, read the board */
+  if (st->n == 1) {
+    for (i=5; i>=-5; i--)
+      if (i)
+        key = key*3 + ban_code[(int)board[newidx+step*i]];
+  }
+  else {
+    for (i=5; i>=-5; i--)
+      if (i)
+        key = key*3 + ban_code[ban_piece(board, st, newidx+step*i)];
   }
-  return count;
+  return key;
+}
+
+static int ban_check(padboard_t board, ban_stones *st);
+
+/* check if a free point is banned with tentative pieces */
+static int ban_point(padboard_t board, ban_stones *st, int p) {
+  int result;
+  st->idx[st->n++] = p;
+  result = ban_check(board, st);
+  st->n--;
+  return result;
 }
 
-/* count open 3 in a line (for black only) */
-static inline int count_open_3(board_t board, pos *newpos, int line) {
-  int i, j, result, start, count;
-  pos p;
-  count = 0;
-  /* match each pattern */
-  for (i=0; i<sizeof(patopen3)/sizeof(char*); i++) {
-    start = -6;
-    /* match until not matched */
-    while (pat_match(board, newpos, line, patopen3[i], start+1, &start))
-      for (j=0; j<strlen(patopen3[i]); j++)
-        if (patopen3[i][j] == '#') {
-          /* if open 3 pattern is matched, place on # and check if it is open 4 */
-          p.x = newpos->x+dirarr[line][0][0]*(start+j);
-          p.y = newpos->y+dirarr[line][0][1]*(start+j);
-          board[p.x][p.y] = I_BLACK;
-          result = count_open_4(board, &p, line);
-          board[p.x][p.y] = I_FREE;
-          if (result)
-            count++;
-        }
-    /* if patopen[0] is matched, do not match patopen[1] */
-    if (i==0 && count)
-      i++;
+/* count matches in a line whose points are checked to be valid */
+/* linestatus: status of the line in ban_table */
+/* need3, need4: count open 3 or 4 if nonzero */
+static void ban_count(padboard_t board, ban_stones *st, int step, uint32_t linestatus,
+    int need3, int need4, int *nthree, int *nfour) {
+  const ban_match *m, *end;
+  int newidx = st->idx[st->n-1];
+  int stop, nthree0, valid;
+  m = &ban_matches[BAN_LINE_START(linestatus)];
+  end = m + BAN_LINE_NTHREE(linestatus) + BAN_LINE_NFOUR(linestatus);
+  /* skip open 3 if not needed */
+  if (!need3)
+    m += BAN_LINE_NTHREE(linestatus);
+  /* skip 4 if not needed */
+  if (!need4)
+    end -= BAN_LINE_NFOUR(linestatus);
+  /* group stopped by an invalid match */
+  stop = -1;
+  /* open 3 of patopen3[0] */
+  nthree0 = 0;
+  for (; m<end; m++) {
+    /* a match is invalid if its points are not valid, so are the rest */
+    /* of its pattern */
+    if (m->group == stop)
+      continue;
+    /* patopen3[0] and patopen3[1] are exclusive */
+    if (m->group == BAN_GROUP_OPEN3+1 && nthree0)
+      continue;
+    if ((m->free[0] && ban_point(board, st, newidx+step*m->free[0])) ||
+        (m->free[1] && ban_point(board, st, newidx+step*m->free[1])) ||
+        (m->barrier && !ban_point(board, st, newidx+step*m->barrier))) {
+      stop = m->group;
+      continue;
+    }
+    if (m->group >= BAN_GROUP_FOUR) {
+      (*nfour)++;
+      continue;
+    }
+    /* place on # and check if it is open 4 */
+    if (ban_piece(board, st, newidx+step*m->edge[0]) == I_BLACK ||
+        ban_piece(board, st, newidx+step*m->edge[1]) == I_BLACK)
+      continue;
+    st->idx[st->n++] = newidx+step*m->free[0];
+    valid = !ban_point(board, st, newidx+step*m->four[0]) &&
+      !ban_point(board, st, newidx+step*m->four[1]);
+    st->n--;
+    if (valid) {
+      (*nthree)++;
+      if (m->group == BAN_GROUP_OPEN3)
+        nthree0++;
+    }
   }
-  return count;
 }
 
-/* judge if any player has won */
-/* newpos indicates the newest placement */
-/* return value is the role of winner or -1 if no winner */
-/* prototype in judge.h */
-int judge(board_t board, pos *newpos) {
-  int i, j, n;
-  int x, y;
-  /* iterate 4 lines  */
-  for (i=0; i<4; i++)
-    if ((board[newpos->x][newpos->y] == I_BLACK &&
-        count_line(board, newpos, i, 0) == 5) ||
-        (board[newpos->x][newpos->y] == I_WHITE &&
-        count_line(board, newpos, i, 0) >= 5))
-      return board[newpos->x][newpos->y] - 1;
+/* look up lines of the last tentative piece */
+/* lines: status of each line in ban_table */
+/* return value is 0 or 1 if the ban is decided by the lines, otherwise -1 */
+static int ban_lookup(padboard_t board, ban_stones *st, uint32_t *lines) {
+  int i, nthree, nfour;
+  int newidx = st->idx[st->n-1];
+  nthree = 0;
+  nfour = 0;
+  for (i=0; i<4; i++) {
+    lines[i] = ban_table[ban_key(board, st, newidx, steparr[i])];
+    /* 5 reached, ban is no longer valid */
+    if (BAN_LINE_STATUS(lines[i]) == BAN_LINE_FIVE)
+      return 0;
+    /* check overline */
+    if (BAN_LINE_STATUS(lines[i]) == BAN_LINE_OVERLINE)
+      return 1;
+    nthree += BAN_LINE_NTHREE(lines[i]);
+    nfour += BAN_LINE_NFOUR(lines[i]);
+  }
+  /* 3-3 & 4-4 are impossible without checking points */
+  if (nthree < 2 && nfour < 2)
+    return 0;
   return -1;
 }
 
-/* check if newpos is banned */
-/* return value is nonzero if banned */
+/* check 3-3 & 4-4 of the last tentative piece */
+/* lines: status of each line looked up by ban_lookup */
+static int ban_verify(padboard_t board, ban_stones *st, uint32_t *lines) {
+  int i, nthree, nfour, need3, need4;
+  /* count only if possible */
+  nthree = 0;
+  nfour = 0;
+  for (i=0; i<4; i++) {
+    nthree += BAN_LINE_NTHREE(lines[i]);
+    nfour += BAN_LINE_NFOUR(lines[i]);
+  }
+  need3 = nthree >= 2;
+  need4 = nfour >= 2;
+  /* count valid matches */
+  nthree = 0;
+  nfour = 0;
+  for (i=0; i<4; i++)
+    if (BAN_LINE_NTHREE(lines[i]) || BAN_LINE_NFOUR(lines[i])) {
+      ban_count(board, st, steparr[i], lines[i], need3, need4, &nthree, &nfour);
+      /* check 3-3 & 4-4 */
+      if (nthree >= 2 || nfour >= 2)
+        return 1;
+    }
+  return 0;
+}
+
+/* check if the last tentative piece is banned */
+static int ban_check(padboard_t board, ban_stones *st) {
+  uint32_t lines[4];
+  int result;
+  result = ban_lookup(board, st, lines);
+  if (result >= 0)
+    return result;
+  return ban_verify(board, st, lines);
+}
+
+/* check if a point is banned on padded board */
 /* only black may encounter banned position */
 /* do not checkban for white */
 /* prototype in judge.h */
-int checkban(board_t board, pos *newpos) {
-  int result;
-  int i, lcount;
-  int open3count, alive4count;
-  result = 0;
+int checkban_pad(padboard_t board, int newidx) {
+  ban_stones st;
   /* occupied position cannot be checkban'ed */
-  if (board[newpos->x][newpos->y] != I_FREE) {
+  if (board[newidx] != I_FREE)
     return 0;
-  }
+  pthread_once(&ban_once, ban_prepare);
   /* tentative placement */
-  board[newpos->x][newpos->y] = I_BLACK;
-  open3count = 0;
-  alive4count = 0;
-  for (i=0; i<4; i++) {
-    lcount = count_line(board, newpos, i, 0);
-    /* 5 reached, ban is no longer valid */
-    if (lcount == 5) {
-      result = 0;
-      goto _exit;
-    }
-    /* check overline */
-    if (lcount > 5) {
-      result = 1;
-      goto _exit;
-    }
-    /* count patterns only when at least 3 pieces exists (spaces allowed) */
-    /* this improves efficiency */
-    if (count_line(board, newpos, i, 1) >= 3) {
-      /* count open 3 */
-      open3count += count_open_3(board, newpos, i);
-      /* count alive 4 */
-      alive4count += count_open_4(board, newpos, i) + count_dash_4(board, newpos, i);
-    }
+  st.n = 1;
+  st.idx[0] = newidx;
+  return ban_check(board, &st);
+}
+
+/* check if newpos is banned */
+/* prototype in judge.h */
+int checkban(board_t board, pos *newpos) {
+  padboard_t pb;
+  padboard_from_board(pb, board);
+  return checkban_pad(pb, PADBOARD_INDEX(newpos->x, newpos->y));
+}
+
+/* prototype in judge.h */
+void banmap_init(banmap *bm) {
+  memset(bm, 0, sizeof(banmap));
+}
+
+/* prototype in judge.h */
+void banmap_update(banmap *bm, int x, int y) {
+  /* bit y shifted by 16, so that y-5 is never negative */
+  uint64_t bit = (uint64_t)1 << (y+16);
+  int i;
+  /* vertical line within distance 5 */
+  BANMAP_KNOWN(bm, x) &= ~(uint32_t)(((bit << 6) - (bit >> 5)) >> 16);
+  /* other lines within distance 5, padding columns absorb the rest */
+  for (i=1; i<=5; i++) {
+    BANMAP_KNOWN(bm, x-i) &= ~(uint32_t)((bit | bit << i | bit >> i) >> 16);
+    BANMAP_KNOWN(bm, x+i) &= ~(uint32_t)((bit | bit << i | bit >> i) >> 16);
   }
-  /* check 3-3 & 4-4 */
-  if (open3count >= 2 || alive4count >= 2) {
-    result = 1;
-    goto _exit;
+}
+
+/* prototype in judge.h */
+void banmap_place(banmap *bm, int x, int y, uint32_t *saved) {
+  /* columns x-5~x+5, the ones changed by banmap_update */
+  memcpy(saved, &BANMAP_KNOWN(bm, x-BANMAP_PAD), (BANMAP_PAD*2+1)*sizeof(uint32_t));
+  memcpy(saved+BANMAP_PAD*2+1, &BANMAP_BANNED(bm, x-BANMAP_PAD), (BANMAP_PAD*2+1)*sizeof(uint32_t));
+  banmap_update(bm, x, y);
+}
+
+/* prototype in judge.h */
+void banmap_remove(banmap *bm, int x, const uint32_t *saved) {
+  /* status cached after placement elsewhere does not depend on x */
+  memcpy(&BANMAP_KNOWN(bm, x-BANMAP_PAD), saved, (BANMAP_PAD*2+1)*sizeof(uint32_t));
+  memcpy(&BANMAP_BANNED(bm, x-BANMAP_PAD), saved+BANMAP_PAD*2+1, (BANMAP_PAD*2+1)*sizeof(uint32_t));
+}
+
+/* prototype in judge.h */
+int banmap_check(banmap *bm, padboard_t board, int x, int y) {
+  ban_stones st;
+  uint32_t lines[4];
+  uint32_t bit = 1u << y;
+  int result;
+  /* cached */
+  if (BANMAP_KNOWN(bm, x) & bit)
+    return (BANMAP_BANNED(bm, x) & bit) != 0;
+  st.n = 1;
+  st.idx[0] = PADBOARD_INDEX(x, y);
+  /* occupied position cannot be checkban'ed */
+  if (board[st.idx[0]] != I_FREE)
+    return 0;
+  pthread_once(&ban_once, ban_prepare);
+  /* cache the status decided by the lines */
+  result = ban_lookup(board, &st, lines);
+  if (result >= 0) {
+    BANMAP_KNOWN(bm, x) |= bit;
+    if (result)
+      BANMAP_BANNED(bm, x) |= bit;
+    else
+      BANMAP_BANNED(bm, x) &= ~bit;
+    return result;
   }
-_exit:
-  /* unplacement */
-  board[newpos->x][newpos->y] = I_FREE;
-  return result;
+  return ban_verify(board, &st, lines);
 }
@@ -3,12 +3,20 @@
  * 
  * functions in this module are guaranteed to be thread-safe
  *
+ * Points past the border are barriers for ban checking. Before the
+ * padded board, a point past the lower border was bounds checked on x
+ * by mistake and read from the board array, so on boards of 16 and up a
+ * black stone at the top of the next column was taken for a stone past
+ * the lower border, and fours and threes ending there were missed.
+ * judge_base.c keeps that version for judge_fuzz --baseline.
+ *
  */
 
 #ifndef JUDGE_H
 #define JUDGE_H
 
 #include "gomoku.h"
+#include "padboard.h"
 
 /*
  * judge: judge if any player has won
@@ -36,4 +44,122 @@ int judge(board_t board, pos *newpos);
 
 int checkban(board_t board, pos *newpos);
 
+/*
+ * judge_pad: judge if any player has won on padded board
+ *
+ * Parameters:
+ *    board: the padded board
+ *    newidx: index of the position most recently placed on
+ *
+ * Return value:
+ *    the role id of the winner, or -1 if no winner
+ */
+
+int judge_pad(padboard_t board, int newidx);
+
+/*
+ * checkban_pad: check if a position is banned for black on padded board
+ *
+ * Parameters:
+ *    board: the padded board (not modified)
+ *    newidx: index of the position to be checked
+ *
+ * Return value:
+ *    nonzero if the position is banned, otherwise 0
+ */
+
+int checkban_pad(padboard_t board, int newidx);
+
+/*
+ * About ban map
+ * A ban map caches ban status of points for a board. Status decided by
+ * the points within distance 5 on the 4 lines through a point is
+ * cached when checked, and dropped by banmap_update when any of these
+ * points changes, so the map follows the board at the cost of a few
+ * bit operations per move. Points whose 3-3 or 4-4 has to be verified
+ * depend on farther points, and are checked every time.
+ * In search, banmap_place saves the columns it changes and banmap_remove
+ * restores them, so the status cached before a move is kept after the
+ * move is taken back.
+ *
+ */
+
+/* width of padding columns on each side of a ban map */
+#define BANMAP_PAD 5
+
+/* ban map */
+/* use BANMAP_KNOWN and BANMAP_BANNED to access */
+typedef struct {
+  uint32_t known[BOARD_MAX+BANMAP_PAD*2]; /* points with cached status (bit = y) */
+  uint32_t banned[BOARD_MAX+BANMAP_PAD*2]; /* banned points, valid if known */
+} banmap;
+
+/* number of words saved by banmap_place */
+#define BANMAP_SAVED ((BANMAP_PAD*2+1)*2)
+
+/* columns of a ban map */
+#define BANMAP_KNOWN(bm, x) ((bm)->known[(x)+BANMAP_PAD])
+#define BANMAP_BANNED(bm, x) ((bm)->banned[(x)+BANMAP_PAD])
+
+/*
+ * banmap_init: initialize a ban map with nothing cached
+ *
+ * Parameters:
+ *    bm: the ban map
+ *
+ */
+
+void banmap_init(banmap *bm);
+
+/*
+ * banmap_update: drop cached status depending on a point
+ *
+ * Parameters:
+ *    bm: the ban map
+ *    x, y: the point placed on or removed from
+ *
+ */
+
+void banmap_update(banmap *bm, int x, int y);
+
+/*
+ * banmap_place: drop cached status depending on a point placed on,
+ * saving the columns to be restored by banmap_remove
+ *
+ * Parameters:
+ *    bm: the ban map
+ *    x, y: the point placed on
+ *    saved: receives BANMAP_SAVED words
+ *
+ */
+
+void banmap_place(banmap *bm, int x, int y, uint32_t *saved);
+
+/*
+ * banmap_remove: restore a ban map when a point placed on by
+ * banmap_place is removed, in the reverse order of placement
+ *
+ * Parameters:
+ *    bm: the ban map
+ *    x: column of the point removed
+ *    saved: the words saved by banmap_place
+ *
+ */
+
+void banmap_remove(banmap *bm, int x, const uint32_t *saved);
+
+/*
+ * banmap_check: check if a position is banned for black using ban map
+ *
+ * Parameters:
+ *    bm: the ban map of board
+ *    board: the padded board
+ *    x, y: the position to be checked
+ *
+ * Return value:
+ *    nonzero if the position is banned, otherwise 0
+ */
+
+int banmap_check(banmap *bm, padboard_t board, int x, int y);
+
 #endif /* JUDGE_H */
@@ -0,0 +1,41 @@
+/*
+ * judge_base.h: Definitions of baseline judgement and ban checking
+ *
+ * functions in this module are the original board_t versions of those
+ * in judge.h, before the padded board, used only as a second reference
+ * by judge_fuzz
+ *
+ */
+
+#ifndef JUDGE_BASE_H
+#define JUDGE_BASE_H
+
+#include "gomoku.h"
+
+/*
+ * base_judge: judge if any player has won (baseline)
+ *
+ * Parameters:
+ *    board: the chess board
+ *    newpos: the position most recently placed on
+ *
+ * Return value:
+ *    the role id of the winner, or -1 if no winner
+ */
+
+int base_judge(board_t board, pos *newpos);
+
+/*
+ * base_checkban: check if a position is banned for black (baseline)
+ *
+ * Parameters:
+ *    board: the chess board (not modified, checked on a copy)
+ *    newpos: the position to be checked
+ *
+ * Return value:
+ *    nonzero if newpos is banned, otherwise 0
+ */
+
+int base_checkban(board_t board, pos *newpos);
+
+#endif /* JUDGE_BASE_H */
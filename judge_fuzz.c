@@ -0,0 +1,651 @@
+/*
+ * judge_fuzz.c: Differential fuzzing and benchmark of judgement and ban
+ * checking
+ *
+ * Positions are generated at random and compared between judge.c and
+ * the reference in judge_ref.c, or with --baseline the original board_t
+ * version in judge_base.c. A mismatch is shrunk to a minimal position
+ * and printed. Throughput of both is reported at the end.
+ * The baseline differs near the lower border of boards of 16 and up
+ * (see judge.h), so mismatches there are expected with --baseline.
+ * The reference is exponential on positions crowded with black, so each
+ * case is bounded in time, and cases running out of time are counted
+ * and skipped.
+ *
+ */
+
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "judge.h"
+#include "judge_ref.h"
+#include "judge_base.h"
+
+/* board size, defined in pai.c for the game */
+int board_size = BOARD_DEFAULT;
+
+/* default number of boards to fuzz */
+#define FUZZ_BOARDS_DEFAULT 10000
+/* default number of boards to benchmark on */
+#define FUZZ_BENCH_DEFAULT 2000
+/* max number of mismatches shrunk and printed */
+#define FUZZ_REPORT_MAX 5
+/* default time bound of a case in milliseconds */
+#define FUZZ_TIMEOUT_DEFAULT 1000
+/* max nesting of a chain of bans */
+#define FUZZ_CHAIN_MAX 6
+
+/* checked functions */
+#define FUZZ_JUDGE 0
+#define FUZZ_JUDGE_PAD 1
+#define FUZZ_CHECKBAN 2
+#define FUZZ_CHECKBAN_PAD 3
+#define FUZZ_BANMAP 4
+#define FUZZ_FUNC_NUM 5
+
+/* names of checked functions */
+static const char *funcnames[] = {
+  "judge", "judge_pad", "checkban", "checkban_pad", "banmap_check"
+};
+
+/* kinds of generated positions */
+#define FUZZ_GEN_RANDOM 0
+#define FUZZ_GEN_LINES 1
+#define FUZZ_GEN_GAME 2
+#define FUZZ_GEN_CHAINS 3
+#define FUZZ_GEN_NUM 4
+
+/* a mismatch found by a case, reported after the case */
+typedef struct {
+  int func;
+  int size;
+  board_t board;
+  pos p;
+} fuzz_mismatch;
+
+/* a benchmarked position */
+typedef struct {
+  int size;
+  board_t board;
+  padboard_t pb;
+} fuzz_pos;
+
+/* random number generator state (xorshift64) */
+static uint64_t m_seed;
+/* board size of generated positions, 0 for random */
+static int m_size;
+/* number of calls compared of each function */
+static long long m_calls[FUZZ_FUNC_NUM];
+/* number of mismatches */
+static int m_mismatches;
+/* mismatches to be reported */
+static fuzz_mismatch m_pending[FUZZ_REPORT_MAX];
+/* number of mismatches to be reported */
+static int m_npending;
+/* time bound of a case in milliseconds */
+static int m_timeout = FUZZ_TIMEOUT_DEFAULT;
+/* number of cases running out of time */
+static int m_timeouts;
+/* where a case running out of time returns to */
+static sigjmp_buf m_timeout_jmp;
+/* nonzero to compare with judge_base.c instead of judge_ref.c */
+static int m_baseline;
+
+/* next random number */
+static inline uint32_t fuzz_rand() {
+  m_seed ^= m_seed << 13;
+  m_seed ^= m_seed >> 7;
+  m_seed ^= m_seed << 17;
+  return (uint32_t)(m_seed >> 32);
+}
+
+/* random number in [0, n) */
+#define FUZZ_RAND(n) (fuzz_rand() % (n))
+
+/* monotonic time in nanoseconds */
+static uint64_t fuzz_time() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+/* leave the running case when its time is up */
+static void fuzz_alarm(int sig) {
+  (void)sig;
+  siglongjmp(m_timeout_jmp, 1);
+}
+
+/* start (ms > 0) or stop (ms = 0) the time bound of a case */
+/* sigsetjmp(m_timeout_jmp, 1) should be called before starting */
+static void fuzz_bound(int ms) {
+  struct itimerval it;
+  memset(&it, 0, sizeof(it));
+  it.it_value.tv_sec = ms/1000;
+  it.it_value.tv_usec = ms%1000*1000;
+  setitimer(ITIMER_REAL, &it, 0);
+}
+
+/* set a random board size unless fixed */
+static void fuzz_size() {
+  static const int sizes[] = {BOARD_MIN, 8, 15, 15, 15, 19, BOARD_MAX};
+  board_size = m_size ? m_size : sizes[FUZZ_RAND(sizeof(sizes)/sizeof(int))];
+}
+
+/* random stones in a random region */
+static void fuzz_gen_random(board_t board) {
+  int i, n, black, region, ox, oy;
+  n = FUZZ_RAND(BOARD_W*BOARD_H/2+1);
+  black = FUZZ_RAND(101);
+  region = BOARD_MIN + FUZZ_RAND(BOARD_W-BOARD_MIN+1);
+  ox = FUZZ_RAND(BOARD_W-region+1);
+  oy = FUZZ_RAND(BOARD_H-region+1);
+  for (i=0; i<n; i++)
+    board[ox+FUZZ_RAND(region)][oy+FUZZ_RAND(region)] =
+      (int)FUZZ_RAND(100) < black ? I_BLACK : I_WHITE;
+}
+
+/* stones on the 4 lines through a point, often near the border */
+/* these are dense in threes, fours and nested ban checks */
+static void fuzz_gen_lines(board_t board) {
+  static const int dirs[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+  int i, k, x, y, cx, cy, r, n, black;
+  /* center, near the border at half chance */
+  cx = FUZZ_RAND(2) ? FUZZ_RAND(3) : FUZZ_RAND(BOARD_W);
+  cy = FUZZ_RAND(2) ? FUZZ_RAND(3) : FUZZ_RAND(BOARD_H);
+  if (FUZZ_RAND(2)) cx = BOARD_W-1-cx;
+  if (FUZZ_RAND(2)) cy = BOARD_H-1-cy;
+  /* lines: a random share of black, free and white 3:1 in the rest */
+  black = FUZZ_RAND(101);
+  for (i=0; i<4; i++)
+    for (k=-5; k<=5; k++) {
+      x = cx+dirs[i][0]*k;
+      y = cy+dirs[i][1]*k;
+      if (!k || !VALID_COORD(x, y))
+        continue;
+      r = FUZZ_RAND(100);
+      board[x][y] = r < black ? I_BLACK : r < black+(100-black)*3/4 ? I_FREE : I_WHITE;
+    }
+  /* scattered stones */
+  n = FUZZ_RAND(11);
+  for (i=0; i<n; i++)
+    board[FUZZ_RAND(BOARD_W)][FUZZ_RAND(BOARD_H)] = FUZZ_RAND(2) ? I_BLACK : I_WHITE;
+}
+
+/* black heavy lines through a chain of free points, each on a line of */
+/* the previous one, so that a ban check of a point depends on 3-3 and */
+/* 4-4 of the next point, nested up to FUZZ_CHAIN_MAX deep */
+static void fuzz_gen_chains(board_t board) {
+  static const int dirs[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+  int i, k, d, x, y, cx, cy, r, n, black;
+  cx = FUZZ_RAND(BOARD_W);
+  cy = FUZZ_RAND(BOARD_H);
+  n = 1 + FUZZ_RAND(FUZZ_CHAIN_MAX);
+  black = 55 + FUZZ_RAND(36);
+  for (d=0; d<n; d++) {
+    /* 2 to 4 lines through the point, within distance 4 */
+    for (i=FUZZ_RAND(3); i<4; i++)
+      for (k=-4; k<=4; k++) {
+        x = cx+dirs[i][0]*k;
+        y = cy+dirs[i][1]*k;
+        if (!k || !VALID_COORD(x, y))
+          continue;
+        r = FUZZ_RAND(100);
+        board[x][y] = r < black ? I_BLACK : r < 97 ? I_FREE : I_WHITE;
+      }
+    board[cx][cy] = I_FREE;
+    /* next point: a free point on the lines */
+    for (k=0; k<16; k++) {
+      i = FUZZ_RAND(4);
+      r = FUZZ_RAND(2) ? 1+FUZZ_RAND(4) : -1-FUZZ_RAND(4);
+      x = cx+dirs[i][0]*r;
+      y = cy+dirs[i][1]*r;
+      if (VALID_COORD(x, y) && board[x][y] == I_FREE)
+        break;
+    }
+    if (k == 16)
+      break;
+    cx = x;
+    cy = y;
+  }
+}
+
+/* call the reference of a function, on board or on its padded board pb */
+/* the baseline has only board_t versions, used for the padded ones too */
+static int fuzz_ref(int func, board_t board, padboard_t pb, pos *p) {
+  int idx = PADBOARD_INDEX(p->x, p->y);
+  if (m_baseline)
+    return func <= FUZZ_JUDGE_PAD ? base_judge(board, p) : base_checkban(board, p);
+  switch (func) {
+    case FUZZ_JUDGE:
+      return ref_judge(board, p);
+    case FUZZ_JUDGE_PAD:
+      return ref_judge_pad(pb, idx);
+    case FUZZ_CHECKBAN:
+      return ref_checkban(board, p);
+    default:
+      return ref_checkban_pad(pb, idx);
+  }
+}
+
+/* call a checked function, or its reference */
+/* results of ban checking are normalized to 0 or 1 */
+static int fuzz_call(int func, int ref, board_t board, pos *p) {
+  padboard_t pb;
+  int idx = PADBOARD_INDEX(p->x, p->y);
+  padboard_from_board(pb, board);
+  if (ref && func <= FUZZ_JUDGE_PAD)
+    return fuzz_ref(func, board, pb, p);
+  if (ref)
+    return !!fuzz_ref(func, board, pb, p);
+  switch (func) {
+    case FUZZ_JUDGE:
+      return judge(board, p);
+    case FUZZ_JUDGE_PAD:
+      return judge_pad(pb, idx);
+    case FUZZ_CHECKBAN:
+      return !!checkban(board, p);
+    default:
+      return !!checkban_pad(pb, idx);
+  }
+}
+
+/* check if a function differs from the reference on a position */
+/* return value is 0 if the reference runs out of time */
+static int fuzz_differs(int func, board_t board, pos *p) {
+  int result;
+  if (sigsetjmp(m_timeout_jmp, 1))
+    return 0;
+  fuzz_bound(m_timeout);
+  result = fuzz_call(func, 0, board, p) != fuzz_call(func, 1, board, p);
+  fuzz_bound(0);
+  return result;
+}
+
+/* shrink a mismatch by removing stones, moving stones toward the */
+/* origin and reducing the board size while it persists */
+static void fuzz_shrink(int func, board_t board, pos *p) {
+  board_t saved;
+  pos savedp;
+  int x, y, dx, size, changed;
+  do {
+    changed = 0;
+    /* remove stones except the checked one */
+    for (x=0; x<BOARD_W; x++)
+      for (y=0; y<BOARD_H; y++) {
+        if (board[x][y] == I_FREE || (x == p->x && y == p->y))
+          continue;
+        saved[x][y] = board[x][y];
+        board[x][y] = I_FREE;
+        if (fuzz_differs(func, board, p))
+          changed = 1;
+        else
+          board[x][y] = saved[x][y];
+      }
+    /* move all stones by one toward the origin */
+    for (dx=0; dx<2; dx++) {
+      memcpy(saved, board, sizeof(board_t));
+      savedp = *p;
+      for (x=0; x<BOARD_W; x++)
+        if (board[dx ? 0 : x][dx ? x : 0] != I_FREE)
+          break;
+      if (x < BOARD_W || (dx ? p->x : p->y) == 0)
+        continue;
+      memset(board, 0, sizeof(board_t));
+      for (x=0; x<BOARD_W; x++)
+        for (y=0; y<BOARD_H; y++)
+          if (saved[x][y] != I_FREE)
+            board[x-dx][y-!dx] = saved[x][y];
+      p->x -= dx;
+      p->y -= !dx;
+      if (fuzz_differs(func, board, p)) {
+        changed = 1;
+      }
+      else {
+        memcpy(board, saved, sizeof(board_t));
+        *p = savedp;
+      }
+    }
+    /* reduce board size if the last row and column are empty */
+    size = board_size;
+    if (size > BOARD_MIN && p->x < size-1 && p->y < size-1) {
+      for (x=0; x<size; x++)
+        if (board[x][size-1] != I_FREE || board[size-1][x] != I_FREE)
+          break;
+      if (x == size) {
+        board_size = size-1;
+        if (fuzz_differs(func, board, p))
+          changed = 1;
+        else
+          board_size = size;
+      }
+    }
+  } while (changed);
+}
+
+/* print a position with the checked point marked */
+/* X: black, O: white, lower case or ?: the checked point */
+static void fuzz_print(board_t board, pos *p) {
+  int x, y;
+  char c;
+  for (y=0; y<BOARD_H; y++) {
+    printf(" %2d ", BOARD_H-y);
+    for (x=0; x<BOARD_W; x++) {
+      c = board[x][y] == I_BLACK ? 'X' : board[x][y] == I_WHITE ? 'O' : '.';
+      if (x == p->x && y == p->y)
+        c = c == '.' ? '?' : c-'A'+'a';
+      printf(" %c", c);
+    }
+    printf("\n");
+  }
+  printf("    ");
+  for (x=0; x<BOARD_W; x++)
+    printf(" %c", 'A'+x);
+  printf("\n");
+}
+
+/* record a mismatch, to be reported after the case */
+static void fuzz_found(int func, board_t board, pos *p) {
+  fuzz_mismatch *m;
+  m_mismatches++;
+  if (m_mismatches > FUZZ_REPORT_MAX)
+    return;
+  m = &m_pending[m_npending++];
+  m->func = func;
+  m->size = board_size;
+  memcpy(m->board, board, sizeof(board_t));
+  m->p = *p;
+}
+
+/* report a mismatch, shrunk unless it is of ban map */
+static void fuzz_report(fuzz_mismatch *m) {
+  board_t shrunk;
+  pos sp = m->p;
+  int func = m->func;
+  int size = board_size;
+  board_size = m->size;
+  memcpy(shrunk, m->board, sizeof(board_t));
+  /* ban map depends on history, so only the position is printed */
+  if (func != FUZZ_BANMAP)
+    fuzz_shrink(func, shrunk, &sp);
+  /* the result of ban map is the opposite of the reference */
+  printf("mismatch of %s at %c%d, size %d: result %d, reference %d\n",
+      funcnames[func], 'A'+sp.x, BOARD_H-sp.y, board_size,
+      func == FUZZ_BANMAP ? !fuzz_call(FUZZ_CHECKBAN_PAD, 1, shrunk, &sp) :
+      fuzz_call(func, 0, shrunk, &sp), fuzz_call(func, 1, shrunk, &sp));
+  fuzz_print(shrunk, &sp);
+  board_size = size;
+}
+
+/* compare all functions on all points of a position */
+static void fuzz_check(board_t board) {
+  padboard_t pb, orig;
+  pos p;
+  int x, y, idx;
+  padboard_from_board(pb, board);
+  memcpy(orig, pb, sizeof(padboard_t));
+  for (x=0; x<BOARD_W; x++)
+    for (y=0; y<BOARD_H; y++) {
+      p.x = x;
+      p.y = y;
+      idx = PADBOARD_INDEX(x, y);
+      if (board[x][y] != I_FREE) {
+        /* judge as if the stone was just placed */
+        m_calls[FUZZ_JUDGE]++;
+        m_calls[FUZZ_JUDGE_PAD]++;
+        if (judge(board, &p) != fuzz_ref(FUZZ_JUDGE, board, orig, &p))
+          fuzz_found(FUZZ_JUDGE, board, &p);
+        if (judge_pad(pb, idx) != fuzz_ref(FUZZ_JUDGE_PAD, board, orig, &p))
+          fuzz_found(FUZZ_JUDGE_PAD, board, &p);
+      }
+      else {
+        m_calls[FUZZ_CHECKBAN]++;
+        m_calls[FUZZ_CHECKBAN_PAD]++;
+        if (!checkban(board, &p) != !fuzz_ref(FUZZ_CHECKBAN, board, orig, &p))
+          fuzz_found(FUZZ_CHECKBAN, board, &p);
+        if (!checkban_pad(pb, idx) != !fuzz_ref(FUZZ_CHECKBAN_PAD, board, orig, &p))
+          fuzz_found(FUZZ_CHECKBAN_PAD, board, &p);
+      }
+    }
+  /* checkban_pad promises not to modify the board */
+  padboard_from_board(orig, board);
+  if (memcmp(pb, orig, sizeof(padboard_t))) {
+    printf("checkban_pad modified the board\n");
+    m_mismatches++;
+  }
+}
+
+/* play random moves near each other, keeping a ban map updated */
+/* and comparing it with the reference after each move */
+static void fuzz_game(board_t board) {
+  padboard_t pb;
+  banmap bm;
+  pos p, last;
+  int i, k, n, x, y;
+  padboard_from_board(pb, board);
+  banmap_init(&bm);
+  last.x = BOARD_W/2;
+  last.y = BOARD_H/2;
+  n = FUZZ_RAND(BOARD_W*BOARD_H/2+1);
+  for (i=0; i<n; i++) {
+    /* take back the last move at times */
+    if (i && FUZZ_RAND(10) == 0 && board[last.x][last.y] != I_FREE) {
+      board[last.x][last.y] = I_FREE;
+      pb[PADBOARD_INDEX(last.x, last.y)] = I_FREE;
+      banmap_update(&bm, last.x, last.y);
+    }
+    /* place near the last move */
+    for (k=0; k<16; k++) {
+      x = last.x+FUZZ_RAND(5)-2;
+      y = last.y+FUZZ_RAND(5)-2;
+      if (VALID_COORD(x, y) && board[x][y] == I_FREE)
+        break;
+    }
+    if (k == 16)
+      continue;
+    board[x][y] = i%2 ? I_WHITE : I_BLACK;
+    pb[PADBOARD_INDEX(x, y)] = board[x][y];
+    banmap_update(&bm, x, y);
+    last.x = x;
+    last.y = y;
+    /* query points near the move, where cached status is dropped */
+    for (k=0; k<4; k++) {
+      p.x = x+FUZZ_RAND(13)-6;
+      p.y = y+FUZZ_RAND(13)-6;
+      if (!VALID_COORD(p.x, p.y) || board[p.x][p.y] != I_FREE)
+        continue;
+      m_calls[FUZZ_BANMAP]++;
+      if (!banmap_check(&bm, pb, p.x, p.y) != !fuzz_ref(FUZZ_BANMAP, board, pb, &p))
+        fuzz_found(FUZZ_BANMAP, board, &p);
+    }
+  }
+}
+
+/* generate a position of a kind and compare all functions on it */
+/* return value is 0 if the case runs out of time */
+static int fuzz_case(int kind, board_t board) {
+  if (sigsetjmp(m_timeout_jmp, 1)) {
+    m_timeouts++;
+    return 0;
+  }
+  fuzz_bound(m_timeout);
+  switch (kind) {
+    case FUZZ_GEN_RANDOM:
+      fuzz_gen_random(board);
+      break;
+    case FUZZ_GEN_LINES:
+      fuzz_gen_lines(board);
+      break;
+    case FUZZ_GEN_GAME:
+      fuzz_game(board);
+      break;
+    case FUZZ_GEN_CHAINS:
+      fuzz_gen_chains(board);
+      break;
+  }
+  fuzz_check(board);
+  fuzz_bound(0);
+  return 1;
+}
+
+/* check if the reference checks bans of a position in time */
+static int fuzz_in_time(board_t board) {
+  pos p;
+  if (sigsetjmp(m_timeout_jmp, 1))
+    return 0;
+  fuzz_bound(m_timeout);
+  for (p.x=0; p.x<BOARD_W; p.x++)
+    for (p.y=0; p.y<BOARD_H; p.y++)
+      fuzz_ref(FUZZ_CHECKBAN, board, 0, &p);
+  fuzz_bound(0);
+  return 1;
+}
+
+/* benchmark a function and its reference on positions */
+static void fuzz_bench(int func, fuzz_pos *ps, int n) {
+  uint64_t t;
+  double rate[2];
+  long long calls;
+  volatile int sink = 0;
+  pos p;
+  int i, x, y, ref, idx;
+  for (ref=0; ref<2; ref++) {
+    calls = 0;
+    t = fuzz_time();
+    for (i=0; i<n; i++) {
+      board_size = ps[i].size;
+      for (x=0; x<BOARD_W; x++)
+        for (y=0; y<BOARD_H; y++) {
+          /* judge on stones, ban checking on free points */
+          if ((ps[i].board[x][y] != I_FREE) != (func <= FUZZ_JUDGE_PAD))
+            continue;
+          p.x = x;
+          p.y = y;
+          idx = PADBOARD_INDEX(x, y);
+          if (ref)
+            sink += fuzz_ref(func, ps[i].board, ps[i].pb, &p);
+          else switch (func) {
+            case FUZZ_JUDGE:
+              sink += judge(ps[i].board, &p);
+              break;
+            case FUZZ_JUDGE_PAD:
+              sink += judge_pad(ps[i].pb, idx);
+              break;
+            case FUZZ_CHECKBAN:
+              sink += checkban(ps[i].board, &p);
+              break;
+            case FUZZ_CHECKBAN_PAD:
+              sink += checkban_pad(ps[i].pb, idx);
+              break;
+          }
+          calls++;
+        }
+    }
+    t = fuzz_time()-t;
+    rate[ref] = t ? calls*1e9/t : 0;
+  }
+  printf("%-14s %12.0f %12.0f %8.2fx\n", funcnames[func],
+      rate[0], rate[1], rate[1] ? rate[0]/rate[1] : 0);
+}
+
+int main(int argc, const char *argv[]) {
+  board_t board;
+  fuzz_pos *ps;
+  struct sigaction sa;
+  pos p;
+  int i, boards = FUZZ_BOARDS_DEFAULT, bench = FUZZ_BENCH_DEFAULT, adversarial = 0;
+  uint64_t t;
+  m_seed = time(0);
+  /* parse options */
+  for (i=1; i<argc; i++) {
+    if (!strncmp(argv[i], "--boards=", 9))
+      boards = atoi(argv[i]+9);
+    else if (!strncmp(argv[i], "--bench=", 8))
+      bench = atoi(argv[i]+8);
+    else if (!strncmp(argv[i], "--seed=", 7))
+      m_seed = strtoull(argv[i]+7, 0, 10);
+    else if (!strncmp(argv[i], "--size=", 7) &&
+        atoi(argv[i]+7) >= BOARD_MIN && atoi(argv[i]+7) <= BOARD_MAX)
+      m_size = atoi(argv[i]+7);
+    else if (!strncmp(argv[i], "--timeout=", 10) && atoi(argv[i]+10) > 0)
+      m_timeout = atoi(argv[i]+10);
+    else if (!strcmp(argv[i], "--adversarial"))
+      adversarial = 1;
+    else if (!strcmp(argv[i], "--baseline"))
+      m_baseline = 1;
+    else {
+      printf(
+          "Usage: %s [options]\n"
+          "Options:\n"
+          "    --boards=<n>\n"
+          "        Number of boards to fuzz (default %d)\n"
+          "    --bench=<n>\n"
+          "        Number of boards to benchmark on, 0 to skip (default %d)\n"
+          "    --seed=<n>\n"
+          "        Seed of random positions (default time)\n"
+          "    --size=<size>\n"
+          "        Board size, %d to %d (default random)\n"
+          "    --timeout=<ms>\n"
+          "        Time bound of each board (default %d)\n"
+          "    --adversarial\n"
+          "        Fuzz only on black heavy chains of nested bans\n"
+          "    --baseline\n"
+          "        Compare with the original board_t version instead\n",
+          argv[0], FUZZ_BOARDS_DEFAULT, FUZZ_BENCH_DEFAULT, BOARD_MIN, BOARD_MAX,
+          FUZZ_TIMEOUT_DEFAULT);
+      return 1;
+    }
+  }
+  /* xorshift state must not be 0 */
+  if (!m_seed)
+    m_seed = 1;
+  printf("seed %llu, reference %s\n", (unsigned long long)m_seed,
+      m_baseline ? "judge_base.c" : "judge_ref.c");
+  /* a case running out of time leaves by the alarm */
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = fuzz_alarm;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGALRM, &sa, 0);
+  /* build tables of judge.c before any case can be left */
+  p.x = p.y = 0;
+  memset(board, 0, sizeof(board_t));
+  checkban(board, &p);
+  /* fuzz */
+  t = fuzz_time();
+  for (i=0; i<boards; i++) {
+    fuzz_size();
+    memset(board, 0, sizeof(board_t));
+    fuzz_case(adversarial ? FUZZ_GEN_CHAINS : i%FUZZ_GEN_NUM, board);
+    /* report mismatches of the case */
+    while (m_npending)
+      fuzz_report(&m_pending[--m_npending]);
+  }
+  t = fuzz_time()-t;
+  for (i=0; i<FUZZ_FUNC_NUM; i++)
+    printf("%-14s %12lld calls\n", funcnames[i], m_calls[i]);
+  printf("%d boards in %.1f s, %d out of time, %d mismatches\n",
+      boards, t/1e9, m_timeouts, m_mismatches);
+  /* benchmark */
+  if (bench > 0) {
+    ps = malloc(bench*sizeof(fuzz_pos));
+    for (i=0; i<bench; i++) {
+      /* positions the reference checks in time */
+      do {
+        fuzz_size();
+        ps[i].size = board_size;
+        memset(ps[i].board, 0, sizeof(board_t));
+        if (i%2)
+          fuzz_gen_lines(ps[i].board);
+        else
+          fuzz_gen_random(ps[i].board);
+      } while (!fuzz_in_time(ps[i].board));
+      padboard_from_board(ps[i].pb, ps[i].board);
+    }
+    printf("%-14s %12s %12s %9s\n", "calls/s", "judge.c", "reference", "speedup");
+    for (i=0; i<=FUZZ_CHECKBAN_PAD; i++)
+      fuzz_bench(i, ps, bench);
+    free(ps);
+  }
+  return m_mismatches ? 2 : 0;
+}
@@ -0,0 +1,294 @@
+/*
+ * judge_ref.c: Reference implementation of judgement and ban checking
+ *
+ * This is the string pattern implementation on the padded board, as
+ * judge.c was before the ban table, kept unchanged apart from names to
+ * check judge.c against. Do not optimize it.
+ * It is not the original board_t version: the padded board made bounds
+ * checks unnecessary, which also dropped the x-for-y typo in the bounds
+ * check of PAT_IS_BARRIER.
+ *
+ */
+
+#include "judge_ref.h"
+
+/*
+ * direction specifications
+ * lines & directions:
+ *                1    1          0
+ *                *     *        *
+ *   0: 1***0 1:  *  2:  *  3:  *
+ *                *       *    *
+ *                0        0  1
+ *
+ *
+ */
+
+/* index steps of the lines on padded board */
+/* usage: steparr[line] */
+static const int steparr[] = {
+  PADBOARD_STEP(0),
+  PADBOARD_STEP(1),
+  PADBOARD_STEP(2),
+  PADBOARD_STEP(3)
+};
+
+/*
+ * patterns:
+ *   *  = piece(black)
+ *   +  = free
+ *   #  = free & to be placed on (should not be banned)
+ *   x  = barrier (white, border, banned)
+ *   -  = non piece (free, white, border)
+ *
+ * open 4: -#****#-
+ * dash 4: -**#**-
+ *         -***#*-
+ *         x****#-
+ * open 3: +***#+
+ *         +**#*+
+ *         (and then become open 4)
+ *
+ */
+
+/* borders are sentinels on padded board, so no bounds are checked */
+
+#define PAT_IS_PIECE(board, p) (board[p] == I_BLACK)
+
+#define PAT_IS_FREE(board, p) (board[p] == I_FREE)
+
+/* if free, checkban later */
+#define PAT_IS_BARRIER(board, p) (board[p] != I_BLACK)
+
+/* patterns for open 4 */
+static const char *patopen4[] = {
+  "-#****#-"
+};
+
+/* patterns for dash 4 */
+static const char *patdash4[] = {
+  "-**#**-", "-***#*-", "-*#***-", "x****#-", "-#****x"
+};
+
+/* patterns for open 3 */
+/* Note: patopen3[0] and patopen3[1] are exclusive */
+static const char *patopen3[] = {
+  "+***#+", "+#***+", "+**#*+", "+*#**+"
+};
+
+/* match a specified position on the board with a char pattern (for black only) */
+/* return value is nonzero if matched */
+static inline int char_match(padboard_t board, int p, char pattern) {
+  switch (pattern) {
+    case '*':
+      if (PAT_IS_PIECE(board, p))
+        return 1;
+      return 0;
+    case '+':
+    case '#':
+      if (PAT_IS_FREE(board, p))
+        return 1;
+      return 0;
+    case 'x':
+    case '-':
+      if (PAT_IS_BARRIER(board, p))
+        return 1;
+      return 0;
+  }
+  return 0;
+}
+
+/* match a line with a pattern (for black only) */
+/* initial start should be -5 */
+/* if matched, return value is nonzero and *result saves the matched position */
+/* to continue the match, set start to previuos *result */
+static int pat_match(padboard_t board, int newidx, int line, const char *pat, int start, int *result) {
+  int i, j;
+  int l = strlen(pat);
+  int p;
+  /* iterate each start index of the pattern */
+  for (i=start; i+l-1<=5; i++, j++)
+    /* match each char in the pattern */
+    for (j=0;
+        char_match(board, newidx+steparr[line]*(i+j), pat[j]);
+        j++
+        )
+      /* j>=l-1, each char is matched */
+      if (j>=l-1) {
+        /* scan '#' or 'x' */
+        for (j=0; j<l; j++) {
+          p = newidx+steparr[line]*(i+j);
+          switch (pat[j]) {
+            case '#':
+              /* # should not be banned */
+              if (ref_checkban_pad(board, p))
+                return 0;
+              break;
+            case 'x':
+              /* x should be barrier or banned */
+              /* (matched as non black, so only free points are checked) */
+              if (board[p] == I_FREE &&
+                  !ref_checkban_pad(board, p))
+                return 0;
+              break;
+          }
+        }
+        if (result) *result = i;
+        return 1;
+      }
+  return 0;
+}
+
+/* count pieces in a line */
+/* if allowspace, space is ignored when counting */
+static inline int count_line(padboard_t board, int newidx, int line, int allowspace) {
+  int i, n, step;
+  int p;
+  char piece = board[newidx];
+  n = 1;
+  /* iterate 2 directions */
+  for (i=0, step=steparr[line]; i<2; i++, step=-step)
+    /* iterate each position until the border */
+    for (p=newidx+step; ; p+=step)
+      if (board[p] == piece)
+        n++;
+      else if (allowspace && board[p] == I_FREE)
+        continue;
+      else
+        break;
+  return n;
+}
+
+/* count open 4 in a line (for black only) */
+static int count_open_4(padboard_t board, int newidx, int line) {
+  int i, start, count;
+  count = 0;
+  /* match each pattern */
+  for (i=0; i<sizeof(patopen4)/sizeof(char*); i++) {
+    start = -6;
+    /* match until not matched */
+    while (pat_match(board, newidx, line, patopen4[i], start+1, &start))
+      count++;
+  }
+  return count;
+}
+
+/* count dash 4 in a line (for black only) */
+static int count_dash_4(padboard_t board, int newidx, int line) {
+  int i, start, count;
+  count = 0;
+  /* match each pattern */
+  for (i=0; i<sizeof(patdash4)/sizeof(char*); i++) {
+    start = -6;
+    /* match until not matched */
+    while (pat_match(board, newidx, line, patdash4[i], start+1, &start))
+      count++;
+  }
+  return count;
+}
+
+/* count open 3 in a line (for black only) */
+static int count_open_3(padboard_t board, int newidx, int line) {
+  int i, j, result, start, count;
+  int p;
+  count = 0;
+  /* match each pattern */
+  for (i=0; i<sizeof(patopen3)/sizeof(char*); i++) {
+    start = -6;
+    /* match until not matched */
+    while (pat_match(board, newidx, line, patopen3[i], start+1, &start))
+      for (j=0; j<strlen(patopen3[i]); j++)
+        if (patopen3[i][j] == '#') {
+          /* if open 3 pattern is matched, place on # and check if it is open 4 */
+          p = newidx+steparr[line]*(start+j);
+          board[p] = I_BLACK;
+          result = count_open_4(board, p, line);
+          board[p] = I_FREE;
+          if (result)
+            count++;
+        }
+    /* if patopen[0] is matched, do not match patopen[1] */
+    if (i==0 && count)
+      i++;
+  }
+  return count;
+}
+
+/* judge if any player has won on padded board */
+/* prototype in judge_ref.h */
+int ref_judge_pad(padboard_t board, int newidx) {
+  int i;
+  /* iterate 4 lines  */
+  for (i=0; i<4; i++)
+    if ((board[newidx] == I_BLACK &&
+        count_line(board, newidx, i, 0) == 5) ||
+        (board[newidx] == I_WHITE &&
+        count_line(board, newidx, i, 0) >= 5))
+      return board[newidx] - 1;
+  return -1;
+}
+
+/* judge if any player has won */
+/* prototype in judge_ref.h */
+int ref_judge(board_t board, pos *newpos) {
+  padboard_t pb;
+  padboard_from_board(pb, board);
+  return ref_judge_pad(pb, PADBOARD_INDEX(newpos->x, newpos->y));
+}
+
+/* check if a point is banned on padded board */
+/* only black may encounter banned position */
+/* do not checkban for white */
+/* prototype in judge_ref.h */
+int ref_checkban_pad(padboard_t board, int newidx) {
+  int result;
+  int i, lcount;
+  int open3count, alive4count;
+  result = 0;
+  /* occupied position cannot be checkban'ed */
+  if (board[newidx] != I_FREE) {
+    return 0;
+  }
+  /* tentative placement */
+  board[newidx] = I_BLACK;
+  open3count = 0;
+  alive4count = 0;
+  for (i=0; i<4; i++) {
+    lcount = count_line(board, newidx, i, 0);
+    /* 5 reached, ban is no longer valid */
+    if (lcount == 5) {
+      result = 0;
+      goto _exit;
+    }
+    /* check overline */
+    if (lcount > 5) {
+      result = 1;
+      goto _exit;
+    }
+    /* count patterns only when at least 3 pieces exists (spaces allowed) */
+    /* this improves efficiency */
+    if (count_line(board, newidx, i, 1) >= 3) {
+      /* count open 3 */
+      open3count += count_open_3(board, newidx, i);
+      /* count alive 4 */
+      alive4count += count_open_4(board, newidx, i) + count_dash_4(board, newidx, i);
+    }
+  }
+  /* check 3-3 & 4-4 */
+  if (open3count >= 2 || alive4count >= 2) {
+    result = 1;
+    goto _exit;
+  }
+_exit:
+  /* unplacement */
+  board[newidx] = I_FREE;
+  return result;
+}
+
+/* check if newpos is banned */
+/* prototype in judge_ref.h */
+int ref_checkban(board_t board, pos *newpos) {
+  padboard_t pb;
+  padboard_from_board(pb, board);
+  return ref_checkban_pad(pb, PADBOARD_INDEX(newpos->x, newpos->y));
+}
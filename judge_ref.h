@@ -0,0 +1,68 @@
+/*
+ * judge_ref.h: Definitions of reference judgement and ban checking
+ *
+ * functions in this module are the slow, straightforward versions of
+ * those in judge.h, used only to check them by judge_fuzz
+ *
+ */
+
+#ifndef JUDGE_REF_H
+#define JUDGE_REF_H
+
+#include "gomoku.h"
+#include "padboard.h"
+
+/*
+ * ref_judge: judge if any player has won (reference)
+ *
+ * Parameters:
+ *    board: the chess board
+ *    newpos: the position most recently placed on
+ *
+ * Return value:
+ *    the role id of the winner, or -1 if no winner
+ */
+
+int ref_judge(board_t board, pos *newpos);
+
+/*
+ * ref_checkban: check if a position is banned for black (reference)
+ *
+ * Parameters:
+ *    board: the chess board
+ *    newpos: the position to be checked
+ *
+ * Return value:
+ *    nonzero if newpos is banned, otherwise 0
+ */
+
+int ref_checkban(board_t board, pos *newpos);
+
+/*
+ * ref_judge_pad: judge if any player has won on padded board (reference)
+ *
+ * Parameters:
+ *    board: the padded board
+ *    newidx: index of the position most recently placed on
+ *
+ * Return value:
+ *    the role id of the winner, or -1 if no winner
+ */
+
+int ref_judge_pad(padboard_t board, int newidx);
+
+/*
+ * ref_checkban_pad: check if a position is banned for black on padded
+ * board (reference)
+ *
+ * Parameters:
+ *    board: the padded board (modified during the call and restored)
+ *    newidx: index of the position to be checked
+ *
+ * Return value:
+ *    nonzero if the position is banned, otherwise 0
+ */
+
+int ref_checkban_pad(padboard_t board, int newidx);
+
+#endif /* JUDGE_REF_H */
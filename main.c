@@ -6,27 +6,68 @@
 #include "cli.h"
 #include "pai.h"
 #include "ai.h"
+#include "hash.h"
+#include "stats.h"
+#include "nnue.h"
+#include "tune.h"
 
 int main(int argc, const char *argv[]) {
-  int i;
+  int i, role;
+  int hashmb = HASHTABLE_DEFAULT_MB, hugepages = 0;
+  /* player types, p or c, registered after all options are parsed */
+  char players[ROLE_MAX] = {0};
+  /* network weight file, loaded after the board size is set */
+  const char *nnuefile = 0;
+  /* tune command, position file, number of threads and pinning */
+  int tune = 0, threads = 0, pin = 0;
+  /* type of AI players */
+  int aitype = AI_TYPE_SPLIT;
+  const char *posfile = 0;
   /* initialize random number generator */
   srand(time(0));
   if (argc == 1) {
     /* show help text */
     printf(
         "Usage: %s <command> [options]\n"
-        "Commands: play\n"
+        "Commands: play, tune\n"
         "Options:\n"
         "    -b<role>\n"
         "    -w<role>\n"
         "        Specify roles for black(b) and white(w) \n"
-        "        role can be p (player) or c (computer)\n",
-        argv[0]);
+        "        role can be p (player) or c (computer)\n"
+        "    --size=<size>\n"
+        "        Board size, %d to %d (default %d)\n"
+        "    --hash-mb=<size>\n"
+        "        Size of hash table in megabytes (default %d)\n"
+        "    --hugepages\n"
+        "        Back hash table with huge pages if possible\n"
+        "    --hash-file=<path>\n"
+        "        Keep hash table in a file across games\n"
+        "    --hash-shm=<name>\n"
+        "        Share hash table with other processes via shared memory\n"
+        "    --stats[=<path>]\n"
+        "        Dump search statistics after each move to stderr or a file\n"
+        "    --nnue=<path>\n"
+        "        Evaluate with the network in a weight file\n"
+        "    --weights=<path>\n"
+        "        Load evaluation weights from a file\n"
+        "    --positions=<path>\n"
+        "        Position file to tune weights with (tune)\n"
+        "    --threads=<n>\n"
+        "        Number of search threads (default 4), or tuning threads\n"
+        "        (default all processors)\n"
+        "    --pin\n"
+        "        Pin search threads to processors\n"
+        "    --ai=<type>\n"
+        "        Parallel search of computer, split (default) or lazysmp\n",
+        argv[0], BOARD_MIN, BOARD_MAX, BOARD_DEFAULT, HASHTABLE_DEFAULT_MB);
     return 0;
   }
   /* parse command */
   if (!strcmp(argv[1], "play"))
     cli_init();
+  else if (!strcmp(argv[1], "tune"))
+    tune = 1;
   else {
     fprintf(stderr, "Invalid command: %s\n", argv[1]);
     return 1;
@@ -34,17 +75,68 @@ int main(int argc, const char *argv[]) {
   /* parse options */
   for (i=2; i<argc; i++)
     if (!strcmp(argv[i], "-bp"))
-      cli_register_player(ROLE_BLACK);
+      players[ROLE_BLACK] = 'p';
     else if (!strcmp(argv[i], "-wp"))
-      cli_register_player(ROLE_WHITE);
+      players[ROLE_WHITE] = 'p';
     else if (!strcmp(argv[i], "-bc"))
-      ai_register_player(ROLE_BLACK, 0);
+      players[ROLE_BLACK] = 'c';
     else if (!strcmp(argv[i], "-wc"))
-      ai_register_player(ROLE_WHITE, 0);
+      players[ROLE_WHITE] = 'c';
+    else if (!strncmp(argv[i], "--size=", 7) && pai_set_board_size(atoi(argv[i]+7)))
+      continue;
+    else if (!strncmp(argv[i], "--hash-mb=", 10) && atoi(argv[i]+10) > 0)
+      hashmb = atoi(argv[i]+10);
+    else if (!strncmp(argv[i], "--hash-file=", 12) && argv[i][12])
+      hashtable_persist(argv[i]+12);
+    else if (!strncmp(argv[i], "--hash-shm=", 11) && argv[i][11])
+      hashtable_share(argv[i]+11);
+    else if (!strcmp(argv[i], "--stats"))
+      stats_open("-");
+    else if (!strncmp(argv[i], "--stats=", 8) && argv[i][8]) {
+      if (!stats_open(argv[i]+8))
+        return 1;
+    }
+    else if (!strcmp(argv[i], "--hugepages"))
+      hugepages = 1;
+    else if (!strncmp(argv[i], "--nnue=", 7) && argv[i][7])
+      nnuefile = argv[i]+7;
+    else if (!strncmp(argv[i], "--weights=", 10) && argv[i][10])
+      ai_weights_file(argv[i]+10);
+    else if (!strncmp(argv[i], "--positions=", 12) && argv[i][12])
+      posfile = argv[i]+12;
+    else if (!strncmp(argv[i], "--threads=", 10) && atoi(argv[i]+10) > 0)
+      threads = atoi(argv[i]+10);
+    else if (!strcmp(argv[i], "--pin"))
+      pin = 1;
+    else if (!strcmp(argv[i], "--ai=split"))
+      aitype = AI_TYPE_SPLIT;
+    else if (!strcmp(argv[i], "--ai=lazysmp"))
+      aitype = AI_TYPE_LAZY_SMP;
     else {
       fprintf(stderr, "Invalid option: %s\n", argv[i]);
       return 1;
     }
+  /* tune weights instead of playing */
+  if (tune) {
+    if (!posfile) {
+      fprintf(stderr, "No position file to tune with\n");
+      return 1;
+    }
+    return !tune_run(posfile, threads);
+  }
+  /* set up hash table */
+  hashtable_config(hashmb, hugepages);
+  /* load network */
+  if (nnuefile && !nnue_load(nnuefile))
+    return 1;
+  /* set up search threads */
+  ai_threads(threads, pin);
+  /* register players */
+  for (role=0; role<ROLE_MAX; role++)
+    if (players[role] == 'p')
+      cli_register_player(role);
+    else if (players[role] == 'c' && !ai_register_player(role, aitype))
+      return 1;
   /* run game */
   return pai_start_game()<0;
 }
@@ -0,0 +1,224 @@
+/*
+ * nnue.c: Implementation of neural network evaluation
+ *
+ */
+
+#include "nnue.h"
+
+/* AVX2 kernels, selected at runtime if the CPU supports them */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define NNUE_AVX2 1
+#include <immintrin.h>
+#else
+#define NNUE_AVX2 0
+#endif
+
+/* number of input points */
+#define NNUE_POINTS (BOARD_MAX*BOARD_MAX)
+
+/* weights of the network, see nnue.h for layout */
+typedef struct {
+  int16_t input[2][NNUE_POINTS][NNUE_HIDDEN]; /* own & opponent's pieces */
+  int16_t bias[NNUE_HIDDEN];
+  int8_t l1[NNUE_L2][NNUE_HIDDEN*2];
+  int32_t l1bias[NNUE_L2];
+  int8_t out[NNUE_L2];
+  int32_t outbias;
+  int32_t scale;
+} nnue_net;
+
+/* header of weight file */
+typedef struct {
+  char magic[8];
+  int32_t version;
+  int32_t boardsize;
+  int32_t hidden;
+  int32_t l2;
+  int32_t scale;
+} nnue_header;
+
+/* magic of weight file */
+static const char m_magic[8] = "GMKNNUE";
+
+/* loaded network */
+static nnue_net *m_net;
+/* nonzero if AVX2 kernels are used */
+static int m_avx2;
+
+/* prototype in nnue.h */
+int nnue_enabled;
+
+/* prototype in nnue.h */
+int nnue_load(const char *path) {
+  FILE *fp;
+  nnue_header header;
+  nnue_net *net;
+  int ok;
+  if (!(fp = fopen(path, "rb"))) {
+    perror(path);
+    return 0;
+  }
+  /* check header */
+  if (fread(&header, sizeof(header), 1, fp) != 1 ||
+      memcmp(header.magic, m_magic, sizeof(m_magic)) ||
+      header.version != NNUE_VERSION ||
+      header.hidden != NNUE_HIDDEN ||
+      header.l2 != NNUE_L2) {
+    fprintf(stderr, "nnue: %s is not a valid weight file\n", path);
+    fclose(fp);
+    return 0;
+  }
+  if (header.boardsize != board_size) {
+    fprintf(stderr, "nnue: %s is for board size %d\n", path, header.boardsize);
+    fclose(fp);
+    return 0;
+  }
+  /* read weights in order of the file */
+  net = malloc(sizeof(nnue_net));
+  ok = net &&
+    fread(net->input, sizeof(net->input), 1, fp) == 1 &&
+    fread(net->bias, sizeof(net->bias), 1, fp) == 1 &&
+    fread(net->l1, sizeof(net->l1), 1, fp) == 1 &&
+    fread(net->l1bias, sizeof(net->l1bias), 1, fp) == 1 &&
+    fread(net->out, sizeof(net->out), 1, fp) == 1 &&
+    fread(&net->outbias, sizeof(net->outbias), 1, fp) == 1;
+  fclose(fp);
+  if (!ok) {
+    fprintf(stderr, "nnue: %s is truncated\n", path);
+    free(net);
+    return 0;
+  }
+  net->scale = header.scale;
+  /* replace previous network */
+  free(m_net);
+  m_net = net;
+#if NNUE_AVX2
+  m_avx2 = __builtin_cpu_supports("avx2");
+#endif
+  nnue_enabled = 1;
+  return 1;
+}
+
+/* add (sign = 1) or subtract (sign = -1) weights of a piece */
+/* loops over NNUE_HIDDEN are vectorized by the compiler */
+static inline void acc_apply(nnue_acc *acc, int index, int role, int sign) {
+  int side, i;
+  int16_t *w;
+  for (side=0; side<2; side++) {
+    /* own pieces are inputs 0, opponent's are inputs 1 */
+    w = m_net->input[role != side][index];
+    if (sign > 0)
+      for (i=0; i<NNUE_HIDDEN; i++)
+        acc->v[side][i] += w[i];
+    else
+      for (i=0; i<NNUE_HIDDEN; i++)
+        acc->v[side][i] -= w[i];
+  }
+}
+
+/* prototype in nnue.h */
+void nnue_refresh(nnue_acc *acc, board_t board) {
+  int i, j;
+  memcpy(acc->v[0], m_net->bias, sizeof(m_net->bias));
+  memcpy(acc->v[1], m_net->bias, sizeof(m_net->bias));
+  for (i=0; i<BOARD_W; i++)
+    for (j=0; j<BOARD_H; j++)
+      if (board[i][j] != I_FREE)
+        acc_apply(acc, i*BOARD_MAX+j, board[i][j]-1, 1);
+}
+
+/* prototype in nnue.h */
+void nnue_update(nnue_acc *acc, int x, int y, int role, int remove) {
+  acc_apply(acc, x*BOARD_MAX+y, role, remove ? -1 : 1);
+}
+
+/* clip a value to [0, 127] */
+static inline int clip(int v) {
+  return v < 0 ? 0 : v > 127 ? 127 : v;
+}
+
+/* layer 1 without shift and clipping */
+static void layer1_scalar(const uint8_t *in, int32_t *h) {
+  int i, j;
+  for (j=0; j<NNUE_L2; j++) {
+    h[j] = m_net->l1bias[j];
+    for (i=0; i<NNUE_HIDDEN*2; i++)
+      h[j] += in[i] * m_net->l1[j][i];
+  }
+}
+
+#if NNUE_AVX2
+
+/* AVX2 version of layer1_scalar */
+/* 32 products of unsigned inputs and signed weights at once */
+/* (pairs of products are at most 2*127*127, no saturation) */
+/* 4 outputs are computed together to share the final sums */
+__attribute__((target("avx2")))
+static void layer1_avx2(const uint8_t *in, int32_t *h) {
+  int i, j, k;
+  __m256i x, sum[4], ones = _mm256_set1_epi16(1);
+  __m128i s;
+  for (j=0; j<NNUE_L2; j+=4) {
+    for (k=0; k<4; k++)
+      sum[k] = _mm256_setzero_si256();
+    for (i=0; i<NNUE_HIDDEN*2; i+=32) {
+      x = _mm256_load_si256((__m256i*)&in[i]);
+      for (k=0; k<4; k++)
+        sum[k] = _mm256_add_epi32(sum[k], _mm256_madd_epi16(ones,
+              _mm256_maddubs_epi16(x, _mm256_loadu_si256((__m256i*)&m_net->l1[j+k][i]))));
+    }
+    /* sum up lanes, lane k of s is output j+k */
+    sum[0] = _mm256_hadd_epi32(_mm256_hadd_epi32(sum[0], sum[1]), _mm256_hadd_epi32(sum[2], sum[3]));
+    s = _mm_add_epi32(_mm256_castsi256_si128(sum[0]), _mm256_extracti128_si256(sum[0], 1));
+    s = _mm_add_epi32(s, _mm_loadu_si128((__m128i*)&m_net->l1bias[j]));
+    _mm_storeu_si128((__m128i*)&h[j], s);
+  }
+}
+
+/* AVX2 version of clipping accumulators to inputs of layer 1 */
+__attribute__((target("avx2")))
+static void clip_avx2(const int16_t *v, uint8_t *in) {
+  int i;
+  __m256i a, b;
+  for (i=0; i<NNUE_HIDDEN; i+=32) {
+    a = _mm256_loadu_si256((__m256i*)&v[i]);
+    b = _mm256_loadu_si256((__m256i*)&v[i+16]);
+    /* saturate to [0, 255], then limit to 127 */
+    /* packus interleaves 128-bit lanes, fixed by permute */
+    a = _mm256_min_epu8(_mm256_packus_epi16(a, b), _mm256_set1_epi8(127));
+    _mm256_store_si256((__m256i*)&in[i], _mm256_permute4x64_epi64(a, 0xd8));
+  }
+}
+
+#endif /* NNUE_AVX2 */
+
+/* prototype in nnue.h */
+int nnue_evaluate(nnue_acc *acc, int role) {
+  uint8_t in[NNUE_HIDDEN*2] __attribute__((aligned(32)));
+  int32_t h[NNUE_L2];
+  int i;
+  int64_t out;
+  /* side to move first */
+#if NNUE_AVX2
+  if (m_avx2) {
+    clip_avx2(acc->v[role], in);
+    clip_avx2(acc->v[role^1], in+NNUE_HIDDEN);
+    layer1_avx2(in, h);
+  } else
+#endif
+  {
+    for (i=0; i<NNUE_HIDDEN; i++) {
+      in[i] = clip(acc->v[role][i]);
+      in[NNUE_HIDDEN+i] = clip(acc->v[role^1][i]);
+    }
+    layer1_scalar(in, h);
+  }
+  /* output */
+  out = m_net->outbias;
+  for (i=0; i<NNUE_L2; i++)
+    out += clip(h[i] >> NNUE_SHIFT) * m_net->out[i];
+  out = out * m_net->scale >> 16;
+  if (out > NNUE_SCORE_MAX) out = NNUE_SCORE_MAX;
+  if (out < -NNUE_SCORE_MAX) out = -NNUE_SCORE_MAX;
+  return out;
+}
@@ -0,0 +1,113 @@
+/*
+ * nnue.h: Definitions of neural network evaluation
+ *
+ * functions in this module are guaranteed to be thread-safe
+ * after the network is loaded
+ *
+ */
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "gomoku.h"
+
+/*
+ * About the network
+ * An optional small quantized network replacing the board score at
+ * leaf nodes. Its inputs are the pieces of both sides on each point.
+ *
+ *   accumulator: NNUE_HIDDEN int16 per side, from the view of that side
+ *                (bias plus weights of pieces, own pieces first)
+ *   layer 1:     both accumulators clipped to [0, 127], side to move
+ *                first, then NNUE_L2 int8 weights each, int32 bias,
+ *                shifted right by NNUE_SHIFT and clipped to [0, 127]
+ *   output:      NNUE_L2 int8 weights, int32 bias,
+ *                multiplied by scale and shifted right by 16
+ *
+ * The accumulators are updated incrementally on each move, so that
+ * only the two small layers are computed at each leaf.
+ *
+ * Weight file (little endian):
+ *   char magic[8] "GMKNNUE", int32 version, int32 board size,
+ *   int32 NNUE_HIDDEN, int32 NNUE_L2, int32 scale,
+ *   int16 input weights [2 (own, opponent)][BOARD_MAX*BOARD_MAX][NNUE_HIDDEN],
+ *   int16 input bias [NNUE_HIDDEN],
+ *   int8 layer 1 weights [NNUE_L2][NNUE_HIDDEN*2], int32 layer 1 bias [NNUE_L2],
+ *   int8 output weights [NNUE_L2], int32 output bias
+ * Points are numbered x*BOARD_MAX+y, and the board size must match.
+ *
+ */
+
+/* version of weight file */
+#define NNUE_VERSION 1
+
+/* sizes of layers */
+#define NNUE_HIDDEN 128
+#define NNUE_L2 32
+
+/* shift of layer 1 */
+#define NNUE_SHIFT 6
+
+/* max absolute value of scores */
+#define NNUE_SCORE_MAX 10000000
+
+/* accumulators of a board */
+typedef struct {
+  int16_t v[2][NNUE_HIDDEN]; /* black & white */
+} __attribute__((aligned(32))) nnue_acc;
+
+/* nonzero if a network is loaded */
+extern int nnue_enabled;
+
+/*
+ * nnue_load: load network from a weight file
+ *
+ * Parameters:
+ *    path: path of the weight file
+ *
+ * Return value:
+ *    nonzero for success, otherwise 0
+ *
+ */
+
+int nnue_load(const char *path);
+
+/*
+ * nnue_refresh: calculate accumulators of a board
+ *
+ * Parameters:
+ *    acc: accumulators to be calculated
+ *    board: the chess board
+ *
+ */
+
+void nnue_refresh(nnue_acc *acc, board_t board);
+
+/*
+ * nnue_update: update accumulators by difference
+ *
+ * Parameters:
+ *    acc: accumulators to be updated
+ *    x, y: the point
+ *    role: role of the piece
+ *    remove: place (0) or remove (nonzero)
+ *
+ */
+
+void nnue_update(nnue_acc *acc, int x, int y, int role, int remove);
+
+/*
+ * nnue_evaluate: evaluate a board
+ *
+ * Parameters:
+ *    acc: accumulators of the board
+ *    role: side to move
+ *
+ * Return value:
+ *    score of the board for role, within [-NNUE_SCORE_MAX, NNUE_SCORE_MAX]
+ *
+ */
+
+int nnue_evaluate(nnue_acc *acc, int role);
+
+#endif /* NNUE_H */
@@ -0,0 +1,16 @@
+/*
+ * padboard.c: Implementation of padded board
+ *
+ */
+
+#include "padboard.h"
+
+/* build padded board from board_t */
+/* prototype in padboard.h */
+void padboard_from_board(padboard_t pb, board_t board) {
+  int i;
+  /* border everywhere, then copy the board */
+  memset(pb, I_BORDER, sizeof(padboard_t));
+  for (i=0; i<BOARD_W; i++)
+    memcpy(pb+PADBOARD_INDEX(i, 0), board[i], BOARD_H);
+}
@@ -0,0 +1,64 @@
+/*
+ * padboard.h: Definitions of padded board
+ *
+ * functions in this module are guaranteed to be thread-safe
+ *
+ */
+
+#ifndef PADBOARD_H
+#define PADBOARD_H
+
+#include "gomoku.h"
+
+/*
+ * About padded board
+ * The board is stored in a linear array surrounded by a border of
+ * I_BORDER sentinels wide enough for pattern matching, so that lines
+ * are walked by adding a constant step to the index and never leave
+ * the array. Points outside [0, BOARD_W) x [0, BOARD_H) are sentinels
+ * as well.
+ *
+ * directions (same as linearr in ai.c):
+ *   0: (1,0)   step = PADBOARD_STRIDE
+ *   1: (0,1)   step = 1
+ *   2: (1,1)   step = PADBOARD_STRIDE+1
+ *   3: (1,-1)  step = PADBOARD_STRIDE-1
+ *
+ */
+
+/* border sentinel, never matches a piece or a free point */
+#define I_BORDER 3
+
+/* width of border */
+#define PADBOARD_PAD 5
+/* distance between rows (at least BOARD_MAX+PADBOARD_PAD*2) */
+#define PADBOARD_STRIDE 32
+/* length of the array */
+#define PADBOARD_LEN ((BOARD_MAX+PADBOARD_PAD*2)*PADBOARD_STRIDE)
+
+/* padded board is a 1-dimension array */
+typedef char padboard_t[PADBOARD_LEN];
+
+/* index of a point */
+#define PADBOARD_INDEX(x, y) \
+    (((x)+PADBOARD_PAD)*PADBOARD_STRIDE+(y)+PADBOARD_PAD)
+
+/* index step of direction d */
+#define PADBOARD_STEP(d) ( \
+    (d) == 0 ? PADBOARD_STRIDE : \
+    (d) == 1 ? 1 : \
+    (d) == 2 ? PADBOARD_STRIDE+1 : \
+    PADBOARD_STRIDE-1 )
+
+/*
+ * padboard_from_board: build padded board from board_t
+ *
+ * Parameters:
+ *    pb: the padded board to be built
+ *    board: the chess board
+ *
+ */
+
+void padboard_from_board(padboard_t pb, board_t board);
+
+#endif /* PADBOARD_H */
@@ -23,28 +23,37 @@ static PAI_DISPLAY_CALLBACK m_dcallback;
 
 /* the board maintained by PAI */
 static board_t m_board;
+/* padded board and ban map of m_board */
+static padboard_t m_padboard;
+static banmap m_banmap;
+
+/* board size */
+int board_size = BOARD_DEFAULT;
 
 /* position record */
-#define RECORD_MAX 256
+#define RECORD_MAX (BOARD_MAX*BOARD_MAX)
 pos record_pos[RECORD_MAX];
 
 /* when move count reaches this value, check banned positions */
 #define CHECKFREE_THRESHOLD 200
 
 /* check if all free positions are banned */
-static int isallbanned(board_t board) {
+static int isallbanned() {
   int i, j;
-  pos p;
   for (i=0; i<BOARD_W; i++)
-    for (j=0; j<BOARD_H; j++) {
-      p.x = i;
-      p.y = j;
-      if (board[i][j] == I_FREE && !checkban(board, &p))
+    for (j=0; j<BOARD_H; j++)
+      if (m_board[i][j] == I_FREE && !banmap_check(&m_banmap, m_padboard, i, j))
         return 0;
-    }
   return 1;
 }
 
+/* set a point of m_board, and keep m_padboard and m_banmap updated */
+static void setpoint(pos *p, int piece) {
+  m_board[p->x][p->y] = piece;
+  m_padboard[PADBOARD_INDEX(p->x, p->y)] = piece;
+  banmap_update(&m_banmap, p->x, p->y);
+}
+
 /* prototype in pai.h */
 int pai_register_player(int role, PAI_PLAYER_CALLBACK callback, void *userdata, int autoexit)
 {
@@ -81,6 +90,8 @@ int pai_start_game()
   /* initialize stuffs */
   
   memset(m_board, 0, sizeof(m_board));
+  padboard_from_board(m_padboard, m_board);
+  banmap_init(&m_banmap);
   running = 1;
   move = 0;
   role = ROLE_BLACK;
@@ -136,13 +147,13 @@ int pai_start_game()
       if (m_board[newpos.x][newpos.y] == I_FREE) {
 
         /* check bans */
-        if (role == ROLE_BLACK && checkban(m_board, &newpos)) {
+        if (role == ROLE_BLACK && banmap_check(&m_banmap, m_padboard, newpos.x, newpos.y)) {
           msg = "position banned, retrying";
           break;
         }
 
         /* do placement */
-        m_board[newpos.x][newpos.y] = ROLE2ISTATUS(role);
+        setpoint(&newpos, ROLE2ISTATUS(role));
         newest = newpos;
 
         /* record step */
@@ -158,7 +169,7 @@ int pai_start_game()
       }
 
       /* judge */
-      if ((winner = judge(m_board, &newpos)) >= 0) {
+      if ((winner = judge_pad(m_padboard, PADBOARD_INDEX(newpos.x, newpos.y))) >= 0) {
         msg = winner ? "white win" : "black win";
       }
 
@@ -172,8 +183,8 @@ int pai_start_game()
       move++;
 
       /* check if the game ends in a draw */
-      if (move > BOARD_W*BOARD_H ||
-          (move > CHECKFREE_THRESHOLD && isallbanned(m_board))) {
+      if (move >= BOARD_W*BOARD_H ||
+          (move > CHECKFREE_THRESHOLD && isallbanned())) {
         winner = 2;
         msg = "end in a draw";
       }
@@ -185,9 +196,9 @@ int pai_start_game()
       /* do unplacement from step record */
       if (move>=2) {
         move--;
-        m_board[record_pos[move].x][record_pos[move].y] = I_FREE;
+        setpoint(&record_pos[move], I_FREE);
         move--;
-        m_board[record_pos[move].x][record_pos[move].y] = I_FREE;
+        setpoint(&record_pos[move], I_FREE);
         /* restore newest */
         if (move>0) newest = record_pos[move-1];
         msg = "most recent turn has been undone";
@@ -222,6 +233,14 @@ int pai_start_game()
 
 }
 
+/* prototype in pai.h */
+int pai_set_board_size(int size) {
+  /* check size */
+  if (size < BOARD_MIN || size > BOARD_MAX) return 0;
+  board_size = size;
+  return 1;
+}
+
 int pai_register_display(PAI_DISPLAY_CALLBACK callback) {
   /* simply save the callback */
   m_dcallback = callback;
@@ -137,6 +137,19 @@ int pai_start_game();
 
 int pai_register_display(PAI_DISPLAY_CALLBACK callback);
 
+/*
+ * pai_set_board_size: Set the board size
+ *
+ * size: width and height of the board (BOARD_MIN ~ BOARD_MAX)
+ *
+ * Return value: nonzero on success, zero on failure
+ *
+ * Must be called before any player is registered.
+ *
+ */
+
+int pai_set_board_size(int size);
+
 /*
  * pai_time: Get time counter in milliseconds
  *
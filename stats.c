@@ -0,0 +1,70 @@
+/*
+ * stats.c: Implementation of search statistics
+ *
+ */
+
+#include "stats.h"
+
+/* counters of all threads */
+static stat_slot m_slot[STATS_SLOTS];
+/* output stream, null if disabled */
+static FILE *m_fp;
+
+/* prototype in stats.h */
+int stats_enabled;
+
+/* counters of the calling thread, main thread by default */
+__thread stat_slot *stats_current = &m_slot[0];
+
+/* prototype in stats.h */
+void stats_bind(int slot) {
+  stats_current = &m_slot[slot % STATS_SLOTS];
+}
+
+/* prototype in stats.h */
+int stats_open(const char *path) {
+  if (!strcmp(path, "-"))
+    m_fp = stderr;
+  else if (!(m_fp = fopen(path, "a"))) {
+    perror(path);
+    return 0;
+  }
+  stats_enabled = 1;
+  return 1;
+}
+
+/* ratio in percent */
+static double percent(uint64_t a, uint64_t b) {
+  return b ? 100.0 * a / b : 0.0;
+}
+
+/* prototype in stats.h */
+void stats_dump(int move, int usage) {
+  int i, j;
+  uint64_t c[stat_max] = {0};
+  /* sum up counters */
+  for (i=0; i<STATS_SLOTS; i++)
+    for (j=0; j<stat_max; j++)
+      c[j] += m_slot[i].count[j];
+  /* reset counters */
+  memset(m_slot, 0, sizeof(m_slot));
+  if (!m_fp) return;
+  fprintf(m_fp,
+      "move %d: nodes %llu cutoffs %llu (first %.1f%%) "
+      "probes %llu hits %.1f%% (exact %llu alpha %llu beta %llu) "
+      "depth %.2f stores %llu overwrites %.1f%% usage %.1f%%\n",
+      move,
+      (unsigned long long)c[stat_node],
+      (unsigned long long)c[stat_cutoff],
+      percent(c[stat_cutoff_first], c[stat_cutoff]),
+      (unsigned long long)c[stat_probe],
+      percent(c[stat_hit], c[stat_probe]),
+      (unsigned long long)c[stat_hit_exact],
+      (unsigned long long)c[stat_hit_alpha],
+      (unsigned long long)c[stat_hit_beta],
+      c[stat_probe] ? (double)c[stat_probe_depth] / c[stat_probe] : 0.0,
+      (unsigned long long)c[stat_store],
+      percent(c[stat_overwrite], c[stat_store]),
+      usage / 10.0);
+  fflush(m_fp);
+}
@@ -0,0 +1,101 @@
+/*
+ * stats.h: Definitions of search statistics
+ *
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "gomoku.h"
+
+/*
+ * About statistics
+ * Counters are kept per thread in cache-line aligned slots, so that
+ * updating them causes no traffic between threads. They are summed and
+ * dumped after each move if enabled.
+ *
+ */
+
+/* counter ids */
+typedef enum {
+  /* hash table */
+  stat_probe, /* lookups */
+  stat_hit, /* lookups returning a usable value */
+  stat_hit_exact, /* hits on exact nodes */
+  stat_hit_alpha, /* hits on alpha nodes */
+  stat_hit_beta, /* hits on beta nodes */
+  stat_probe_depth, /* entries examined by lookups */
+  stat_store, /* stores */
+  stat_overwrite, /* stores replacing another position */
+  /* search */
+  stat_node, /* nodes searched */
+  stat_cutoff, /* beta cuttings */
+  stat_cutoff_first, /* beta cuttings on the first move */
+  stat_max
+} stat_id;
+
+/* counters of a thread */
+typedef struct {
+  uint64_t count[stat_max];
+} __attribute__((aligned(64))) stat_slot;
+
+/* max number of threads with separate counters */
+#define STATS_SLOTS 64
+
+/* counters of the calling thread */
+extern __thread stat_slot *stats_current;
+
+/* nonzero if statistics are enabled by stats_open */
+extern int stats_enabled;
+
+/* build with -DSTATS_COUNTERS=0 to compile counters out */
+#ifndef STATS_COUNTERS
+#define STATS_COUNTERS 1
+#endif
+
+/* increase a counter of the calling thread */
+/* counters are touched only when enabled, so the search does not pay */
+/* for thread-local updates otherwise */
+#if STATS_COUNTERS
+#define STAT_ADD(id, n) \
+    do { if (stats_enabled) stats_current->count[id] += (n); } while (0)
+#else
+#define STAT_ADD(id, n) do { } while (0)
+#endif
+#define STAT_INC(id) STAT_ADD(id, 1)
+
+/*
+ * stats_bind: use separate counters for the calling thread
+ *
+ * Parameters:
+ *    slot: slot number (0 for main thread)
+ *
+ */
+
+void stats_bind(int slot);
+
+/*
+ * stats_open: enable dumping of statistics
+ *
+ * Parameters:
+ *    path: file to append to, or "-" for stderr
+ *
+ * Return value:
+ *    nonzero for success, otherwise 0
+ *
+ */
+
+int stats_open(const char *path);
+
+/*
+ * stats_dump: dump and reset counters of all threads
+ *
+ * Parameters:
+ *    move: current move count
+ *    usage: per mille of hash table entries in use
+ *
+ */
+
+void stats_dump(int move, int usage);
+
+#endif /* STATS_H */
@@ -0,0 +1,265 @@
+/*
+ * tune.c: Implementation of evaluation weight tuning
+ *
+ */
+
+#include <math.h>
+
+#include "tune.h"
+#include "pai.h"
+#include "cli.h"
+#include "ai.h"
+
+/* max length of a line of the position file */
+#define TUNE_LINE_MAX 4096
+
+/* max number of local search passes */
+#define TUNE_PASS_MAX 1000
+
+/* range of log10(1/K) scanned for the sigmoid scale K */
+#define TUNE_SCALE_MIN 1.0
+#define TUNE_SCALE_MAX 9.0
+#define TUNE_SCALE_STEP 0.05
+
+/* a position of the set */
+typedef struct {
+  int start; /* index of the first move in m_moves */
+  int n; /* number of moves */
+  double result; /* result for black */
+} tune_pos;
+
+/* work of a thread, over positions [begin, end) */
+typedef struct {
+  int begin, end;
+  int weight; /* feature: index of the weight being extracted */
+  double scale; /* error: sigmoid scale K */
+  const double *w; /* error: weights */
+  double error; /* error: sum of squared errors, output */
+} tune_job;
+
+/* moves of all positions */
+static pos *m_moves;
+static int m_nmoves;
+/* positions */
+static tune_pos *m_pos;
+static int m_npos;
+/* score of each position for black, by each weight set to 1 */
+/* usage: m_feature[position*AI_WEIGHT_NUM+weight] */
+static double *m_feature;
+/* number of threads */
+static int m_threads;
+
+/* read positions from a file */
+/* 0 on failure, non-0 on success */
+static int tune_read(const char *path) {
+  FILE *fp;
+  char line[TUNE_LINE_MAX];
+  char *p, *tok, *end;
+  board_t board;
+  pos move;
+  int lineno = 0, cappos = 0, capmoves = 0, ok = 1;
+  double result;
+  if (!(fp = fopen(path, "r"))) {
+    perror(path);
+    return 0;
+  }
+  while (ok && fgets(line, sizeof(line), fp)) {
+    lineno++;
+    /* strip comment */
+    if ((p = strchr(line, '#')))
+      *p = 0;
+    /* result */
+    if (!(tok = strtok(line, " \t\r\n")))
+      continue;
+    result = strtod(tok, &end);
+    if (*end || result < 0 || result > 1) {
+      fprintf(stderr, "tune: %s:%d: invalid result %s\n", path, lineno, tok);
+      ok = 0;
+      break;
+    }
+    /* grow position array */
+    if (m_npos == cappos) {
+      cappos = cappos ? cappos*2 : 1024;
+      m_pos = realloc(m_pos, cappos*sizeof(tune_pos));
+    }
+    m_pos[m_npos].start = m_nmoves;
+    m_pos[m_npos].n = 0;
+    m_pos[m_npos].result = result;
+    /* moves */
+    memset(board, 0, sizeof(board_t));
+    while ((tok = strtok(0, " \t\r\n"))) {
+      if (!cli_parse_coordinate(tok, &move) ||
+          move.x < 0 || move.x >= BOARD_W ||
+          move.y < 0 || move.y >= BOARD_H ||
+          board[move.x][move.y] != I_FREE) {
+        fprintf(stderr, "tune: %s:%d: invalid move %s\n", path, lineno, tok);
+        ok = 0;
+        break;
+      }
+      board[move.x][move.y] = I_BLACK;
+      /* grow move array */
+      if (m_nmoves == capmoves) {
+        capmoves = capmoves ? capmoves*2 : 65536;
+        m_moves = realloc(m_moves, capmoves*sizeof(pos));
+      }
+      m_moves[m_nmoves++] = move;
+      m_pos[m_npos].n++;
+    }
+    m_npos++;
+  }
+  fclose(fp);
+  if (ok && !m_npos) {
+    fprintf(stderr, "tune: %s has no positions\n", path);
+    ok = 0;
+  }
+  return ok;
+}
+
+/* thread routine extracting a feature of positions */
+static void* tune_feature_routine(void *parameter) {
+  tune_job *job = (tune_job *)parameter;
+  board_t board;
+  tune_pos *tp;
+  int i, k, role, score;
+  for (i=job->begin; i<job->end; i++) {
+    tp = &m_pos[i];
+    /* replay moves, alternating from black */
+    memset(board, 0, sizeof(board_t));
+    for (k=0; k<tp->n; k++)
+      board[m_moves[tp->start+k].x][m_moves[tp->start+k].y] = k%2 ? I_WHITE : I_BLACK;
+    /* evaluate for the side to move, and convert to black */
+    role = tp->n%2 ? ROLE_WHITE : ROLE_BLACK;
+    score = ai_evaluate(board, role);
+    m_feature[i*AI_WEIGHT_NUM+job->weight] = role == ROLE_BLACK ? score : -score;
+  }
+  return 0;
+}
+
+/* thread routine summing squared errors of positions */
+static void* tune_error_routine(void *parameter) {
+  tune_job *job = (tune_job *)parameter;
+  const double *f;
+  double score, d, sum = 0;
+  int i, k;
+  for (i=job->begin; i<job->end; i++) {
+    f = &m_feature[i*AI_WEIGHT_NUM];
+    score = 0;
+    for (k=0; k<AI_WEIGHT_NUM; k++)
+      score += f[k]*job->w[k];
+    d = m_pos[i].result - 1/(1+exp(-job->scale*score));
+    sum += d*d;
+  }
+  job->error = sum;
+  return 0;
+}
+
+/* run routine on all positions, split to m_threads jobs */
+/* job: template of jobs */
+/* return: sum of errors of all jobs */
+static double tune_parallel(void *(*routine)(void *), tune_job *job) {
+  tune_job *jobs;
+  pthread_t *tid;
+  double sum = 0;
+  int i;
+  jobs = malloc(m_threads*sizeof(tune_job));
+  tid = malloc(m_threads*sizeof(pthread_t));
+  for (i=0; i<m_threads; i++) {
+    jobs[i] = *job;
+    jobs[i].begin = (long long)m_npos*i/m_threads;
+    jobs[i].end = (long long)m_npos*(i+1)/m_threads;
+    pthread_create(&tid[i], 0, routine, &jobs[i]);
+  }
+  for (i=0; i<m_threads; i++) {
+    pthread_join(tid[i], 0);
+    sum += jobs[i].error;
+  }
+  free(jobs);
+  free(tid);
+  return sum;
+}
+
+/* mean squared error of weights */
+static double tune_error(const int *weights, double scale) {
+  double w[AI_WEIGHT_NUM];
+  tune_job job;
+  int i;
+  for (i=0; i<AI_WEIGHT_NUM; i++)
+    w[i] = weights[i];
+  job.w = w;
+  job.scale = scale;
+  job.error = 0;
+  return tune_parallel(tune_error_routine, &job)/m_npos;
+}
+
+/* prototype in tune.h */
+int tune_run(const char *path, int threads) {
+  ai_weights weights, unit;
+  tune_job job;
+  int step[AI_WEIGHT_NUM];
+  int i, dir, value, pass, changed;
+  double error, best, scale, e;
+  m_threads = threads > 0 ? threads : sysconf(_SC_NPROCESSORS_ONLN);
+  if (m_threads < 1)
+    m_threads = 1;
+  if (!ai_init() || !tune_read(path))
+    return 0;
+  fprintf(stderr, "tune: %d positions, %d threads\n", m_npos, m_threads);
+  /* extract features by setting each weight to 1 in turn */
+  ai_get_weights(weights);
+  m_feature = malloc((size_t)m_npos*AI_WEIGHT_NUM*sizeof(double));
+  for (i=0; i<AI_WEIGHT_NUM; i++) {
+    memset(unit, 0, sizeof(ai_weights));
+    unit[i] = 1;
+    ai_set_weights(unit);
+    job.weight = i;
+    job.error = 0;
+    tune_parallel(tune_feature_routine, &job);
+  }
+  ai_set_weights(weights);
+  /* fit sigmoid scale to the initial weights */
+  best = -1;
+  scale = 1;
+  for (e=TUNE_SCALE_MIN; e<=TUNE_SCALE_MAX; e+=TUNE_SCALE_STEP) {
+    error = tune_error(weights, pow(10, -e));
+    if (best < 0 || error < best) {
+      best = error;
+      scale = pow(10, -e);
+    }
+  }
+  fprintf(stderr, "tune: K %g, error %.8f\n", scale, best);
+  /* local search, halving the step of a weight if it does not improve */
+  for (i=0; i<AI_WEIGHT_NUM; i++)
+    step[i] = weights[i]/4 > 1 ? weights[i]/4 : 1;
+  for (pass=1; pass<=TUNE_PASS_MAX; pass++) {
+    changed = 0;
+    for (i=0; i<AI_WEIGHT_NUM; i++) {
+      for (dir=-1; dir<=1; dir+=2) {
+        value = weights[i];
+        weights[i] = value+dir*step[i];
+        if (weights[i] >= 0 && (error = tune_error(weights, scale)) < best) {
+          best = error;
+          changed = 1;
+          break;
+        }
+        weights[i] = value;
+      }
+      /* no improvement in both directions */
+      if (dir > 1 && step[i] > 1) {
+        step[i] /= 2;
+        changed = 1;
+      }
+    }
+    fprintf(stderr, "tune: pass %d, error %.8f\n", pass, best);
+    /* converged */
+    if (!changed)
+      break;
+  }
+  /* print tuned weights */
+  printf("# %d positions, K %g, error %.8f\n", m_npos, scale, best);
+  ai_save_weights(stdout, weights);
+  ai_set_weights(weights);
+  free(m_feature);
+  free(m_moves);
+  free(m_pos);
+  return 1;
+}
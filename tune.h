@@ -0,0 +1,45 @@
+/*
+ * tune.h: Definitions of evaluation weight tuning
+ *
+ */
+
+#ifndef TUNE_H
+#define TUNE_H
+
+#include "gomoku.h"
+
+/*
+ * About tuning
+ * Weights are fitted to game results of a position set (Texel's method):
+ * the static evaluation of each position is mapped to a winning
+ * probability by a sigmoid, and the weights are adjusted by local search
+ * to minimize the mean squared error against the results.
+ * The evaluation is linear in the weights, so the contribution of each
+ * weight is computed once per position, and errors are then summed by
+ * all threads over parts of the set.
+ *
+ * Each line of the position file is the result for black (1, 0.5 or 0)
+ * followed by the moves from an empty board, alternating from black,
+ * such as "1 H8 I9 H9". Text after # is ignored.
+ *
+ */
+
+/*
+ * tune_run: tune evaluation weights and print them to stdout
+ *
+ * The weights loaded by ai_init are the starting point, and the tuned
+ * weights are printed in the format of ai_load_weights.
+ * The board size should be set before calling.
+ *
+ * Parameters:
+ *    path: path of the position file
+ *    threads: number of threads, or 0 for all processors
+ *
+ * Return value:
+ *    nonzero for success, otherwise 0
+ *
+ */
+
+int tune_run(const char *path, int threads);
+
+#endif /* TUNE_H */
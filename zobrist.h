@@ -1,453 +0,0 @@
-#include <stdint.h>
-const uint64_t zobrist[450] = {
-0xbb82f4f562d6544a,
-0xbd412137ab120a5f,
-0x6b49964140f4a8cd,
-0x30be012b20ee5f63,
-0x7643da77716cecf5,
-0xffd23d0d149b2aec,
-0x47fb67fc1607e665,
-0x5cc090fb70a0fef3,
-0xf944d5d53aa9d246,
-0x84519ecc327a7395,
-0x1fb1c5e705f93070,
-0x3a4a49584fa56e18,
-0x702b9e1fa5dd9ac9,
-0xddc7ea12fcb56bac,
-0x920453689d563935,
-0xb442b3720627f12d,
-0x27e2c83b51640a8c,
-0xa66baae551289d44,
-0x8b4ccb9f8b3c1203,
-0xaea17b35147e49a2,
-0x5ebe2df9ca8094a1,
-0xe899f08616989b6a,
-0xbf1387c048b3c870,
-0x39a2d5c64e7da523,
-0x71214cf6eaeac19e,
-0x9cb977ac87ad5d76,
-0xad1dae4a82a2059c,
-0x43d9580287786f9c,
-0x60844d49240a2907,
-0x21bbf8b83907654d,
-0x85614277c01ffdd7,
-0x8a84f3ee0495b623,
-0x9a7f84d3f7afad8e,
-0x9bd504207a5a927b,
-0xc6452bf52250b405,
-0xaecb20680780519f,
-0x0988b050037b26d8,
-0x40dd29fefa930f95,
-0x988d4d0dbab2766e,
-0x2347ff3a1fb179f2,
-0x5e575a3468dbd7e1,
-0x8a70c336ab8a3d82,
-0x929dc775c1effe38,
-0xe061e3358f0d155d,
-0x050f7bc9dda97430,
-0xa693b22be8b7678f,
-0x097536afa0248eca,
-0x24031c82afefbb8b,
-0x63f1922a67d7fe2b,
-0x8ab861bfe09dc808,
-0x780fe59bfb97050b,
-0xcc40ed2eb37aa4e4,
-0x69197573a1abd415,
-0x5bce89d0b0eaa806,
-0xdd842fed1203c679,
-0x9ced5b43714ea88f,
-0xb2cfdcc33e7e9d2e,
-0x8c9ceab49bda9338,
-0x36c398ecf2a1ea4b,
-0x9964188f46eba41b,
-0xdededcc435f00744,
-0x5dcecd65d7c9d6ba,
-0x755e998435d12d10,
-0x8a64fb7b60d6c48b,
-0xe33b68b3526dcb4a,
-0x05619e329cc6d231,
-0x635f07013ac0e633,
-0x67db28a57a7b3ae7,
-0x2f7f3ef87d31ba57,
-0x0ec1f846d2a8e327,
-0xb34bebe6a2f60583,
-0x507d55b8c5e7a0d1,
-0x43071639aef3d519,
-0x297fa7ac9fd8dcb3,
-0xb7cca38840bde1de,
-0xce8f8ead69e75be0,
-0xe846a1380e22c2bc,
-0x382974040e9c398d,
-0x40d9de42e6bad627,
-0x06165b1602a8bb13,
-0xa3763b7be6e0acf5,
-0x7608521634fc0c3d,
-0xd4cbe606796bea59,
-0xc013d0c4ea22e4f8,
-0xb18661dfb26080b4,
-0x5951627e892a4941,
-0x7b857252b90910f5,
-0xfd08f3e78a5b7f44,
-0xdaaef38ad05c5989,
-0x021971e71a89824f,
-0x8bc74b8432454d07,
-0x78986ccd5fbe832a,
-0x6faf74d4990a4f72,
-0x95cc87552819aed4,
-0x0163e45661751eb4,
-0xacfc7d38e4668e17,
-0xf20b0bf4d55ff395,
-0x72d4ff837c8c5f13,
-0x8177cf56ce8a3c1e,
-0xa633a5426646c1da,
-0xa98f6150b5653cb6,
-0x69efb131a3481b4a,
-0x1ab7d2dafcd4e4c6,
-0xae7f923fd199b0e4,
-0x15e2970f0635c45a,
-0xb247cff3b08b1b58,
-0xe2e1d5761ffeed5e,
-0xf8f461e1f81ccbd8,
-0x62ea691a025f3411,
-0x69c01200409040e0,
-0x921aea1084565f77,
-0x4abb712cf82a06db,
-0x21ff3a045de2cac5,
-0x8fca6386b4313771,
-0x6ccfa06cefcbbdb0,
-0x0c1161ecaa0a3736,
-0xfb1e8ed7883808eb,
-0xeee08c2bcae92fc1,
-0x4e5a15308a725a89,
-0xcc9fb63513baca6b,
-0x13989c596c9bb4f3,
-0x10581def600083eb,
-0x9c4d8a5f79656948,
-0xe7fc23d799d63872,
-0xfa1275fe84e70b61,
-0xd32cbf378ddedcf5,
-0x9c562c46002ff92a,
-0x9ef60d860f71e751,
-0x2dbe8477658fdab1,
-0x20caa8fb9166eacd,
-0x3c936d0d2e67e582,
-0x1bec03af5627b575,
-0xaf420b542cd250cb,
-0x9e2417c829a1aba8,
-0x97c20de7beca8072,
-0xce6389228214624f,
-0x6522662deca108c2,
-0x22b61b3e5386fdcc,
-0xc187cfcd3c4b64c7,
-0xcd2529acf581406d,
-0x723142bf6745cd3d,
-0x4b8f914a415f78ee,
-0x17e1623ab8209c86,
-0x7cbe818f8a557a73,
-0xd26fdce889e10d8a,
-0xc82bccffaa21d8cd,
-0x86ae219ad4b50cf5,
-0x2776cd86ecbe76c0,
-0x86523d3dd871abcb,
-0x94e2580e8ebcd722,
-0x175a6fad594ad275,
-0x16f2e7147a43ee5b,
-0x1e7db1e23de05c54,
-0xaccda9a3183934a7,
-0x34865ca1b084d90f,
-0x701c01174d5e05b6,
-0xe88abddcfd9e785e,
-0x4ad6ae3c4bfd5690,
-0x9582f0dd03b6cc60,
-0x20982a0a3fb23122,
-0xf20f457d223f4b34,
-0x90a6014ae9dac516,
-0xbe5b4572f26f72e7,
-0xf5206b623037ea10,
-0x3782248499dad7a2,
-0x51d85dcc19a42064,
-0x295547f5e595a656,
-0x00eb28b9dce59fc1,
-0x92bad3aa1ee408a3,
-0x1d61fde4f97223b6,
-0x32ea3c6835710b38,
-0x1ea92df29e2c010f,
-0x0f80d672a882c8f5,
-0x6ce3f153fa1eee4e,
-0xd7a88ca374957c03,
-0x673731edc4439e0d,
-0x590f835cbeb0c0b4,
-0xed51e79d21d7e2b3,
-0x7469e4f4df6a8271,
-0xa764e4e5a8efdf1b,
-0x8ded50da437545f3,
-0x270b6236411c477b,
-0x4b49d9bea54cc6f4,
-0xf95eeb37f4928c5b,
-0x98ec4d7808fbcff0,
-0x941259287a169821,
-0xbe53c0b27795ebac,
-0x34d3ff25d76f4fd2,
-0xe0851e823b731dba,
-0xc6a5469ff4f2f4e8,
-0x3304fdfe388f2121,
-0xc1a4b9f196d24f85,
-0xd41ba8cdd7f66116,
-0xf59b984b42b1fe81,
-0xb2e9c8cb260b2eb8,
-0x089a5481b9fef0f2,
-0x7c92bfb587180be9,
-0x86472db2d455a69a,
-0x27e9e9d1dc9ce780,
-0x4345e122b2df39f9,
-0x65d61dcb8e87076a,
-0x33ae9afefb2997a0,
-0xed024fff0169a018,
-0xf1c5dd72dfdf5c7d,
-0x6c8e29c0e2b4d298,
-0xe0b7a36b97b129cf,
-0x191f594df240c06d,
-0xd2462511284d1883,
-0xa3225767236cbf7e,
-0x9bb1dbaf29998c8d,
-0xd30d374126b424d5,
-0x187deba565dd520e,
-0xf1b7c948ea418687,
-0x8f3503b659e5379d,
-0x76265dc728daeb10,
-0xf477dfb26a74ea63,
-0x3d03099e912eeeb7,
-0xc87ac7460c3ed408,
-0x536587f8b9fe5e42,
-0x1baaedd6fd77e6fd,
-0xc7b02cace12fd285,
-0x0a305575b208e6e4,
-0xf3d582a9f6831c0f,
-0xc108db49b4ea9255,
-0x34fc926de063a5c7,
-0x84910d8e0f334a09,
-0xfefb2438944c38d7,
-0xca6defc4b26cd1d7,
-0x3838d419ace6165c,
-0xd01da50a90a05073,
-0xede3bdfc6d393cd2,
-0x6497b859f4bbe73d,
-0x86de37cfddb568cc,
-0x91193d15041e7af8,
-0x31333df5fe158dc5,
-0x5ee1f36aae8ed589,
-0x3ed9ad37288b2fbe,
-0xb77e309e14a2ae0b,
-0x346f05dcce17a362,
-0x7f8766a0bb5aca88,
-0x68882078ccb07063,
-0xb780d6e83e9c8847,
-0x53474533368ad8f6,
-0x24252b3c88513476,
-0x44a4b94613129215,
-0x72f2e345f482dd2f,
-0x22162afe2f9155db,
-0xbf41d7fceaf710eb,
-0x8ade798b705cacef,
-0x92ef52a0741c4afc,
-0xad729f78f0744556,
-0x30fa450ccf61719d,
-0xdd31128d08297147,
-0xdc68eb20710a7b7c,
-0x21e9efbebf7e8960,
-0xbf5b41be07f4c5ad,
-0x1f3b595d57e6b17f,
-0x0c41f3e0f73d4c06,
-0xac5788a0cfeea685,
-0x299a4b08a45201b0,
-0x424e19856fd9e32f,
-0x47dc92ca5be7b445,
-0x19a3555ef9db0429,
-0x9e559b3ff139b2c9,
-0xd2f6ea07c7501906,
-0x46903d3d348aaa0c,
-0x9cd7eb0e93fbb8fd,
-0xa93cef51439a1452,
-0xa7d369493bf13650,
-0x014a44d50fd01d95,
-0x40e292e1b26ed71b,
-0x99fda29444adbbc1,
-0xe3cd3459c365b8ca,
-0x5378f3ccacf0b8dc,
-0x4cd98ad9d0801349,
-0x191910d8fd0a695f,
-0x4c69d7ca713f5544,
-0xfaf4df824de70de1,
-0xb224d9592f16fc11,
-0x55a043bad101ddd4,
-0x5b964b52494238a1,
-0x16bf005a2306d41b,
-0x2cf1e83174eeafc5,
-0x33b7d83e8da805af,
-0x435c068709b75d81,
-0x70a6354a41b79c0f,
-0x329aa05129aa054b,
-0xa4bc91675824dd49,
-0x98bbd26f907af472,
-0xf21c794575aeec71,
-0x75d2a8313879f026,
-0xd8e948eab7f910bc,
-0xd723f8345c3e893c,
-0x8b442cee342d2f27,
-0xca560c4faa28aeb4,
-0xa14a269596f2f127,
-0x83f1f2f17811082c,
-0x502a8cf624a8250a,
-0x92b59d5042baab75,
-0x6a4749c780aeb6b9,
-0x698752e570d84e60,
-0x84ef3b92632d86d7,
-0x25b73bd79267dd53,
-0x6a1e8b93e296fc6c,
-0x462096c3abbcbd7b,
-0x7fd952e3f950b33e,
-0xf40efe2c2e9601f2,
-0x48f81a58b24ea552,
-0x294dc82ca40e0b80,
-0x0da39b1c97739445,
-0x63fe26e2ada7abb2,
-0x6b34ac20b5dc9c60,
-0x35a321752dc6cfcc,
-0x6d937655ac039ce2,
-0x9d3602760a641322,
-0xeed5a578047ac854,
-0x611825545c54c2a7,
-0x8829d1fc12eecdcb,
-0x33fea46101f9aac7,
-0x22c028358174f2f0,
-0xccb6c43a0ff124e2,
-0x6a0751266ce208c1,
-0xb19adb15c626cd11,
-0x1d557e9230700bb7,
-0x18d7a80cc7f6130e,
-0xff61eb8acefed400,
-0xfff600b65fa8bfa6,
-0x6dbe3b12bea9aa40,
-0x1065ddd1cb4eda1f,
-0xb8ce27a1b4ac37c2,
-0x8fff8308d5d26d06,
-0xbe7c0fd3b13ebbf6,
-0x8151dea583e7fab3,
-0x2f5462bfad958546,
-0xcaf1fc3428054cf2,
-0xc09f759a44cd6885,
-0x48814193daaf4cec,
-0xf4e18f64c55fd5b7,
-0x583f4aaf6f9677cb,
-0xff9a3895c57bffe9,
-0x7741504c7506a9c4,
-0x8a0a412b69cf9db0,
-0xf92bb1896ddc9efc,
-0x9dc80313fbb8d722,
-0xe6211b5cd010a895,
-0x319c81cdf2a91bf1,
-0xdcf0ddd916649eb3,
-0xcfed52a6b978111a,
-0x18276c3ae6a37939,
-0xa4c9b2bd3e53690f,
-0x2e311b8baf492e0d,
-0xb97e3b5f95958c76,
-0xf9c7a78b9c84d1c5,
-0xc726edd7f6e858f7,
-0x1a06a32fe0f3bf25,
-0xcaff249a5c96d4bc,
-0xfaf8eec6d9edbd0b,
-0x7ac54aca850f805e,
-0x132b80ee33766637,
-0xa02e35db59f9566c,
-0x20d418942fb78dee,
-0x2f32be1053bbd808,
-0x6bef0ed76026a3ae,
-0xc6aec163ed1e8139,
-0xdc472ebac186c5a0,
-0xfbb3b4ce81e0c0ff,
-0xa1ddb66d187ed688,
-0x861642725cc93ad3,
-0x5ffb4978069900db,
-0xb7b987c644caea08,
-0xf3d1da39c1a23f97,
-0x97aed8d67d659c66,
-0x3318163f234d5510,
-0x59baa03ab7dae4ff,
-0x71a949d26cd5f7e7,
-0x810ff69f3e596751,
-0x0026150c403a97c1,
-0xbbb704fe8bbfad65,
-0x35d732251a4e1c09,
-0xaa5eaeecf6bd3220,
-0x95cf75fe5a412b6e,
-0x0ba1970df2154b40,
-0x4ed042108d422a02,
-0xf9a6933a1aea0e75,
-0xc309ca8968748927,
-0x9a29ed5a18e08a2b,
-0x76afe1bdd2723b4d,
-0xf7313566cc66f993,
-0x8b1d1221de10e1fc,
-0xbb579a87a137ab2f,
-0xd76e89d88657ca55,
-0xef1753be51dbf208,
-0x0e88b2d73f310171,
-0x1fe2e0fab24d58ca,
-0x101041093e55d8ff,
-0x6022e8a86c69db2d,
-0x01cf2d7631b90665,
-0x75c24b1aab26ab39,
-0x525f96485702ad7d,
-0x377dbaea112f598d,
-0x9d9e92074112c195,
-0x24eee5429f9c3cf9,
-0xfa594f3fed940ba9,
-0xd98b63b83f933f69,
-0x6019338f2f14fdad,
-0x5173798bc7b44ba3,
-0x8f26e82ba0b842a6,
-0x2fc209a1450aa2a3,
-0xa937d4bcff2c518c,
-0x7f03b2aa3f6fde82,
-0x94dc9bbdf05d6df5,
-0x9f7106b7d5b2cd27,
-0xe9a2b67c502c1eba,
-0x4855dd715868aa04,
-0x985f8f446d422deb,
-0xd574adae13546f6b,
-0x1129c856a902add8,
-0xd938cfc20c09ee57,
-0xd1ae770b4dcb6385,
-0xf266c3994d92130c,
-0xc206c4ffcc83495c,
-0x90c5cf75329eb900,
-0xe9dbb90640cb8028,
-0xfd9f7e44a2151b60,
-0x69c63cf2de94af4e,
-0xb6172c643357965c,
-0x04e8898c9960d69d,
-0x998cf3614d348788,
-0xc6e81e31a49bbad7,
-0x1277abffeeb7e6ae,
-0xb38c62499c86d0e5,
-0x118b4e6bdbfb2a3c,
-0x7786c3669d194a09,
-0x38f92bc78941cb0f,
-0xd108a38206803037,
-0xd7346c94bef049a6,
-0xaef8dd85b07c8257,
-0x75dd97f9773fd408,
-0x2305417da2b0aab2,
-0xd3a8b4e16e1448e8,
-0x878fb9c5d4ee408f,
-0x1486a55d3349034c,
-0x2552024fbaff0f29,
-0x3ded6b2c4033e1e1,
-0x8dd01a8b80d5d8b2,
-0x79c8f0b32fc225b1,
-0x8a3f9464497f9ba0,
-0x21c4e6817cd6a53d,
-0x9cd8e344128a9637,
-0x94e300abf5eb6c77
-};